@@ -0,0 +1,460 @@
+/*------------------------------------------------------------------------*/
+/* Benchmarks of the front end on generated formulas.  The phases are
+ * measured in isolation, which requires access to the internal functions,
+ * so the whole front end is included here.  Each measurement runs in its
+ * own process, such that the maximal resident set size is the one of this
+ * measurement only.  The results are printed in CSV format.
+ */
+#include "limboole.c"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/*------------------------------------------------------------------------*/
+
+typedef struct Shape Shape;
+typedef struct Result Result;
+
+struct Shape
+{
+  const char *name;
+  int size;				/* size for scale one */
+  void (*generate) (FILE *, int size);
+};
+
+struct Result
+{
+  size_t bytes;
+  unsigned tokens;
+  unsigned nodes;
+  unsigned clauses;
+  double seconds;
+  long max_rss;				/* in KB */
+};
+
+/*------------------------------------------------------------------------*/
+/* Nested binary operators and negations:
+ *
+ *   (x0 & !(x1 | (x2 -> !(x3 <-> ... xn))))
+ */
+static void
+generate_deep (FILE * file, int size)
+{
+  static const char *ops[4] = { "&", "|", "->", "<->" };
+  int i;
+
+  for (i = 0; i < size; i++)
+    fprintf (file, "(x%d %s %s", i, ops[i & 3], (i & 1) ? "!" : "");
+
+  fprintf (file, "x%d", size);
+
+  for (i = 0; i < size; i++)
+    fputc (')', file);
+
+  fputc ('\n', file);
+}
+
+/*------------------------------------------------------------------------*/
+/* One flat conjunction of distinct variables.
+ */
+static void
+generate_wide (FILE * file, int size)
+{
+  int i;
+
+  for (i = 0; i < size; i++)
+    fprintf (file, "x%d%s", i, (i + 1 == size) ? "\n" :
+	     (i % 10 == 9) ? " &\n" : " & ");
+}
+
+/*------------------------------------------------------------------------*/
+/* A conjunction of implications, which forms a chain of variables.
+ */
+static void
+generate_chain (FILE * file, int size)
+{
+  int i;
+
+  for (i = 0; i < size; i++)
+    fprintf (file, "(x%d -> x%d)%s", i, i + 1,
+	     (i + 1 == size) ? "\n" : " &\n");
+}
+
+/*------------------------------------------------------------------------*/
+/* Each definition uses the previous one twice.  The DAG is linear in the
+ * size but the corresponding tree is exponential.
+ */
+static void
+generate_shared (FILE * file, int size)
+{
+  int i;
+
+  fprintf (file, "d0 := x0;\n");
+
+  for (i = 1; i < size; i++)
+    fprintf (file, "d%d := (d%d & x%d) | (!d%d & !x%d);\n",
+	     i, i - 1, i, i - 1, i);
+
+  fprintf (file, "d%d\n", size - 1);
+}
+
+/*------------------------------------------------------------------------*/
+/* A disjunction of variables with names of 256 characters, which only
+ * differ at the end.
+ */
+#define NAME_LENGTH 256
+
+static void
+generate_names (FILE * file, int size)
+{
+  char prefix[NAME_LENGTH];
+  int i;
+
+  memset (prefix, 'v', NAME_LENGTH - 12);
+  prefix[NAME_LENGTH - 12] = 0;
+
+  for (i = 0; i < size; i++)
+    fprintf (file, "%s%011d%s", prefix, i, (i + 1 == size) ? "\n" : " |\n");
+}
+
+/*------------------------------------------------------------------------*/
+
+static Shape shapes[] = {
+  {"deep", 5000, generate_deep},
+  {"wide", 200000, generate_wide},
+  {"chain", 100000, generate_chain},
+  {"shared", 50000, generate_shared},
+  {"names", 20000, generate_names},
+};
+
+#define NUM_SHAPES (sizeof (shapes) / sizeof (shapes[0]))
+
+static const char *phases[] = {
+  "lex", "parse", "hash", "encode", "pp"
+};
+
+#define NUM_PHASES (sizeof (phases) / sizeof (phases[0]))
+
+/*------------------------------------------------------------------------*/
+
+static char *
+generate (Shape * shape, int size, size_t * bytes_ptr)
+{
+  FILE *file;
+  char *res;
+
+  res = 0;
+  file = open_memstream (&res, bytes_ptr);
+  shape->generate (file, size);
+  fclose (file);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static Mgr *
+parse_text (const char *text)
+{
+  Mgr *res;
+
+  res = init ();
+  res->name = "<bench>";
+  res->text = text;
+
+  if (!parse (res))
+    {
+      fprintf (stderr, "*** benchlimboole: generated formula invalid\n");
+      exit (1);
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Rebuild the nodes of 'src' in a new manager, which only exercises hash
+ * consing without lexing and parsing.
+ */
+static unsigned
+rebuild (Mgr * src)
+{
+  Node **map, *p;
+  unsigned i, res;
+  Mgr *dst;
+
+  map = (Node **) malloc (src->nodes_count * sizeof (Node *));
+
+  i = 0;
+  for (p = src->first; p; p = p->next_inserted)
+    p->idx = i++;
+
+  dst = init ();
+
+  for (p = src->first; p; p = p->next_inserted)
+    {
+      if (p->type == VAR)
+	map[p->idx] = var (dst, p->data.as_name);
+      else
+	map[p->idx] = op (dst, p->type,
+			  map[p->data.as_child[0]->idx],
+			  p->data.as_child[1] ?
+			  map[p->data.as_child[1]->idx] : 0);
+    }
+
+  res = dst->nodes_count;
+  release (dst);
+  free (map);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+measure (Shape * shape, int size, int phase, Result * result)
+{
+  struct rusage usage;
+  double start;
+  char *text;
+  Mgr *mgr;
+  int t;
+
+  memset (result, 0, sizeof (*result));
+  text = generate (shape, size, &result->bytes);
+  mgr = 0;
+
+  if (!strcmp (phases[phase], "lex"))
+    {
+      mgr = init ();
+      mgr->name = "<bench>";
+      mgr->text = text;
+
+      start = wall_clock ();
+      do
+	{
+	  next_token (mgr);
+	  result->tokens++;
+	}
+      while (mgr->token != DONE && mgr->token != ERROR);
+      result->seconds = wall_clock () - start;
+    }
+  else if (!strcmp (phases[phase], "parse"))
+    {
+      start = wall_clock ();
+      mgr = parse_text (text);
+      result->seconds = wall_clock () - start;
+      result->nodes = mgr->nodes_count;
+    }
+  else
+    {
+      mgr = parse_text (text);
+      result->nodes = mgr->nodes_count;
+
+      if (!strcmp (phases[phase], "hash"))
+	{
+	  start = wall_clock ();
+	  result->nodes = rebuild (mgr);
+	  result->seconds = wall_clock () - start;
+	}
+      else if (!strcmp (phases[phase], "encode"))
+	{
+	  connect_solver (mgr);
+	  start = wall_clock ();
+	  tsetin (mgr);
+	  result->seconds = wall_clock () - start;
+
+	  result->clauses = mgr->units;
+	  for (t = VAR; t <= IFF; t++)
+	    result->clauses += mgr->clauses_by_type[t];
+	}
+      else
+	{
+	  assert (!strcmp (phases[phase], "pp"));
+	  mgr->out = fopen ("/dev/null", "w");
+	  mgr->close_out = 1;
+	  start = wall_clock ();
+	  pp (mgr);
+	  fflush (mgr->out);
+	  result->seconds = wall_clock () - start;
+	}
+    }
+
+  mgr->text = 0;
+  release (mgr);
+  free (text);
+
+  getrusage (RUSAGE_SELF, &usage);
+  result->max_rss = usage.ru_maxrss;
+}
+
+/*------------------------------------------------------------------------*/
+/* Run one measurement in a child process and pass the result through a
+ * pipe.  Returns zero if the child failed.
+ */
+static int
+run (Shape * shape, int size, int phase, Result * result)
+{
+  int fds[2], status;
+  pid_t pid;
+  ssize_t n;
+
+  if (pipe (fds))
+    return 0;
+
+  fflush (stdout);
+
+  if (!(pid = fork ()))
+    {
+      close (fds[0]);
+      measure (shape, size, phase, result);
+      n = write (fds[1], result, sizeof (*result));
+      _exit (n != sizeof (*result));
+    }
+
+  close (fds[1]);
+  n = (pid > 0) ? read (fds[0], result, sizeof (*result)) : 0;
+  close (fds[0]);
+
+  if (pid > 0)
+    waitpid (pid, &status, 0);
+
+  return n == sizeof (*result);
+}
+
+/*------------------------------------------------------------------------*/
+
+static double
+per_second (double amount, double seconds)
+{
+  return seconds > 0 ? amount / seconds : 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+#define BENCH_USAGE \
+"usage: benchlimboole [ <option> ... ] [ <shape> ... ]\n" \
+"\n" \
+"  -h             print this command line summary and exit\n" \
+"  -s <scale>     multiply the default sizes by <scale> (default 1)\n" \
+"  -r <runs>      report the fastest of <runs> runs (default 1)\n" \
+"  -p <phase>     only measure <phase>\n" \
+"\n" \
+"shapes: deep, wide, chain, shared, names (default all)\n" \
+"phases: lex, parse, hash, encode, pp (default all)\n"
+
+/*------------------------------------------------------------------------*/
+
+int
+main (int argc, char **argv)
+{
+  unsigned s, p, selected;
+  Result best, result;
+  const char *phase;
+  double scale;
+  int size, i, r;
+  int runs;
+
+  scale = 1;
+  runs = 1;
+  phase = 0;
+  selected = 0;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (!strcmp (argv[i], "-h"))
+	{
+	  printf (BENCH_USAGE);
+	  return 0;
+	}
+      else if (!strcmp (argv[i], "-s") && i + 1 < argc)
+	{
+	  if ((scale = atof (argv[++i])) <= 0)
+	    {
+	      fprintf (stderr, "*** invalid scale '%s'\n", argv[i]);
+	      return 1;
+	    }
+	}
+      else if (!strcmp (argv[i], "-r") && i + 1 < argc)
+	{
+	  if ((runs = atoi (argv[++i])) <= 0)
+	    {
+	      fprintf (stderr, "*** invalid number of runs '%s'\n", argv[i]);
+	      return 1;
+	    }
+	}
+      else if (!strcmp (argv[i], "-p") && i + 1 < argc)
+	{
+	  phase = argv[++i];
+	  for (p = 0; p < NUM_PHASES && strcmp (phases[p], phase); p++)
+	    ;
+	  if (p == NUM_PHASES)
+	    {
+	      fprintf (stderr, "*** unknown phase '%s' (try '-h')\n", phase);
+	      return 1;
+	    }
+	}
+      else if (argv[i][0] == '-')
+	{
+	  fprintf (stderr,
+		   "*** invalid command line option '%s' (try '-h')\n",
+		   argv[i]);
+	  return 1;
+	}
+      else
+	{
+	  for (s = 0; s < NUM_SHAPES && strcmp (shapes[s].name, argv[i]); s++)
+	    ;
+	  if (s == NUM_SHAPES)
+	    {
+	      fprintf (stderr, "*** unknown shape '%s' (try '-h')\n", argv[i]);
+	      return 1;
+	    }
+	  selected |= 1u << s;
+	}
+    }
+
+  if (!selected)
+    selected = (1u << NUM_SHAPES) - 1;
+
+  printf ("shape,size,phase,bytes,tokens,nodes,clauses,seconds,"
+	  "mb_per_sec,nodes_per_sec,clauses_per_sec,max_rss_kb\n");
+
+  for (s = 0; s < NUM_SHAPES; s++)
+    {
+      if (!(selected & (1u << s)))
+	continue;
+
+      size = shapes[s].size * scale;
+      if (size < 1)
+	size = 1;
+
+      for (p = 0; p < NUM_PHASES; p++)
+	{
+	  if (phase && strcmp (phase, phases[p]))
+	    continue;
+
+	  for (r = 0; r < runs; r++)
+	    {
+	      if (!run (shapes + s, size, p, &result))
+		{
+		  fprintf (stderr, "*** benchlimboole: %s %s failed\n",
+			   shapes[s].name, phases[p]);
+		  return 1;
+		}
+
+	      if (!r || result.seconds < best.seconds)
+		best = result;
+	    }
+
+	  printf ("%s,%d,%s,%lu,%u,%u,%u,%.6f,%.2f,%.0f,%.0f,%ld\n",
+		  shapes[s].name, size, phases[p],
+		  (unsigned long) best.bytes, best.tokens, best.nodes,
+		  best.clauses, best.seconds,
+		  per_second (best.bytes / 1048576.0, best.seconds),
+		  per_second (best.nodes, best.seconds),
+		  per_second (best.clauses, best.seconds), best.max_rss);
+	}
+    }
+
+  return 0;
+}
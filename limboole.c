@@ -2,12 +2,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 /*------------------------------------------------------------------------*/
 
 #include "limmat/limmat.h"
+#include "limboole.h"
 
 /*------------------------------------------------------------------------*/
 
@@ -31,12 +42,18 @@ enum Type
   IFF = 7,
   DONE = 8,
   ERROR = 9,
+  DEF = 10,
+  SEMI = 11,
+  COLON = 12,
 };
 
 /*------------------------------------------------------------------------*/
 
 typedef enum Type Type;
-typedef struct Node Node;
+typedef struct LimbooleNode Node;
+typedef struct Def Def;
+typedef struct Query Query;
+typedef struct Cache Cache;
 typedef union Data Data;
 
 /*------------------------------------------------------------------------*/
@@ -49,20 +66,48 @@ union Data
 
 /*------------------------------------------------------------------------*/
 
-struct Node
+struct LimbooleNode
 {
   Type type;
   int idx;			/* tsetin index */
   Node *next;			/* collision chain in hash table */
   Node *next_inserted;		/* chronological list of hash table */
+  Def *def;			/* first definition bound to this node */
+  int mark;			/* cone of influence stamp */
+  int canonical;		/* position in canonical order of cone */
   Data data;
 };
 
+/*------------------------------------------------------------------------*/
+/* A definition 'name := expr;' binds a name to an already hash-consed node.
+ * Definitions are kept in their own hash table, since a defined name does
+ * not become a variable of the formula.
+ */
+struct Def
+{
+  char *name;
+  Node *node;
+  int idx;			/* position in definition order */
+  Def *next;			/* collision chain in hash table */
+  Def *next_inserted;		/* chronological list of definitions */
+};
+
+/*------------------------------------------------------------------------*/
+/* A query 'name : expr;' is checked on its own.  All queries of one input
+ * share the hash-consed nodes and are encoded into the same solver.
+ */
+struct Query
+{
+  char *name;
+  Node *root;
+  Query *next;
+};
+
 /*------------------------------------------------------------------------*/
 
-typedef struct Mgr Mgr;
+typedef struct Limboole Mgr;
 
-struct Mgr
+struct Limboole
 {
   unsigned nodes_size;
   unsigned nodes_count;
@@ -71,10 +116,23 @@ struct Mgr
   Node *first;
   Node *last;
   Node *root;
+  unsigned defs_size;
+  unsigned defs_count;
+  Def **defs;
+  Def *first_def;
+  Def *last_def;
+  Query *first_query;
+  Query *last_query;
+  int pp_limit;
+  int stamp;
   char *buffer;
-  char *name;
+  const char *name;
+  const char *text;		/* parse from string instead of 'in' */
+  char *error;			/* last parse error message */
   unsigned buffer_size;
   unsigned buffer_count;
+  char *saved_buffer;
+  unsigned saved_buffer_size;
   int saved_char;
   int saved_char_is_valid;
   int last_y;
@@ -91,15 +149,44 @@ struct Mgr
   Type token;
   unsigned token_x;
   unsigned token_y;
+  Type saved_token;
+  unsigned saved_token_x;
+  unsigned saved_token_y;
+  int saved_token_is_valid;
   Node **idx2node;
+  int *clauses;			/* clauses buffered by 'tsetin' */
+  unsigned clauses_count;	/* number of literals and zeroes in 'clauses' */
+  Node *encoded;		/* last node encoded by 'tsetin' */
   int check_satisfiability;
   int dump;
+  int max_decisions;
+  double time_limit;
+  int conflict_limit;
+  size_t memory_limit;
+  int exhausted;		/* a limit was exceeded */
+  double parse_time;		/* wall clock time of the phases */
+  double encode_time;
+  double add_time;
+  double solve_time;
+  unsigned nodes_by_type[IFF + 1];
+  unsigned clauses_by_type[IFF + 1];
+  unsigned units;
+  unsigned rehashes;		/* hash table enlargements */
+  double lookups;		/* hash table lookups */
+  double probes;		/* nodes visited during lookups */
+  size_t name_bytes;		/* bytes of variable and definition names */
+  Node **model;			/* variables of last checked formula */
+  int model_size;
+  int model_capacity;
+  signed char *values;		/* last assignment indexed by 'idx' */
+  int num_values;
+  Cache *cache;			/* persistent result cache */
 };
 
 /*------------------------------------------------------------------------*/
 
 static unsigned
-hash_var (Mgr * mgr, const char *name)
+hash_str (const char *name)
 {
   unsigned res, tmp;
   const char *p;
@@ -115,6 +202,17 @@ hash_var (Mgr * mgr, const char *name)
 	res ^= (tmp >> 28);
     }
 
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static unsigned
+hash_var (Mgr * mgr, const char *name)
+{
+  unsigned res;
+
+  res = hash_str (name);
   res &= (mgr->nodes_size - 1);
   assert (res < mgr->nodes_size);
 
@@ -185,10 +283,15 @@ find (Mgr * mgr, Type type, void *c0, Node * c1)
   Node **p, *n;
   unsigned h;
 
+  mgr->lookups++;
+
   h = hash (mgr, type, c0, c1);
   for (p = mgr->nodes + h; (n = *p); p = &n->next)
-    if (eq (n, type, c0, c1))
-      break;
+    {
+      mgr->probes++;
+      if (eq (n, type, c0, c1))
+	break;
+    }
 
   return p;
 }
@@ -201,6 +304,7 @@ enlarge_nodes (Mgr * mgr)
   Node **old_nodes, *p, *next;
   unsigned old_nodes_size, h, i;
 
+  mgr->rehashes++;
   old_nodes = mgr->nodes;
   old_nodes_size = mgr->nodes_size;
   mgr->nodes_size *= 2;
@@ -236,6 +340,7 @@ insert (Mgr * mgr, Node * node)
     mgr->first = node;
   mgr->last = node;
   mgr->nodes_count++;
+  mgr->nodes_by_type[node->type]++;
 }
 
 /*------------------------------------------------------------------------*/
@@ -256,6 +361,7 @@ var (Mgr * mgr, const char *str)
       memset (n, 0, sizeof (*n));
       n->type = VAR;
       n->data.as_name = strdup (str);
+      mgr->name_bytes += strlen (str) + 1;
 
       *p = n;
       insert (mgr, n);
@@ -293,6 +399,95 @@ op (Mgr * mgr, Type type, Node * c0, Node * c1)
 
 /*------------------------------------------------------------------------*/
 
+static Def **
+find_def (Mgr * mgr, const char *name)
+{
+  Def **p, *d;
+  unsigned h;
+
+  h = hash_str (name) & (mgr->defs_size - 1);
+  for (p = mgr->defs + h; (d = *p); p = &d->next)
+    if (!strcmp (d->name, name))
+      break;
+
+  return p;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+enlarge_defs (Mgr * mgr)
+{
+  Def **old_defs, *p, *next;
+  unsigned old_defs_size, h, i;
+
+  old_defs = mgr->defs;
+  old_defs_size = mgr->defs_size;
+  mgr->defs_size *= 2;
+  mgr->defs = (Def **) calloc (mgr->defs_size, sizeof (Def *));
+
+  for (i = 0; i < old_defs_size; i++)
+    {
+      for (p = old_defs[i]; p; p = next)
+	{
+	  next = p->next;
+	  h = hash_str (p->name) & (mgr->defs_size - 1);
+	  p->next = mgr->defs[h];
+	  mgr->defs[h] = p;
+	}
+    }
+
+  free (old_defs);
+}
+
+/*------------------------------------------------------------------------*/
+/* Bind 'name' to 'node'.  The name has to be allocated by the caller and is
+ * owned by the definition afterwards.
+ */
+static void
+define (Mgr * mgr, char *name, Node * node)
+{
+  Def **p, *d;
+
+  if (mgr->defs_size <= mgr->defs_count)
+    enlarge_defs (mgr);
+
+  p = find_def (mgr, name);
+  assert (!*p);
+
+  d = (Def *) malloc (sizeof (*d));
+  memset (d, 0, sizeof (*d));
+  d->name = name;
+  d->node = node;
+  d->idx = mgr->defs_count++;
+  mgr->name_bytes += strlen (name) + 1;
+
+  *p = d;
+  if (mgr->last_def)
+    mgr->last_def->next_inserted = d;
+  else
+    mgr->first_def = d;
+  mgr->last_def = d;
+
+  if (!node->def)
+    node->def = d;
+}
+
+/*------------------------------------------------------------------------*/
+
+static double
+wall_clock (void)
+{
+  struct timeval tv;
+
+  if (gettimeofday (&tv, 0))
+    return 0;
+
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+/*------------------------------------------------------------------------*/
+
 static Mgr *
 init (void)
 {
@@ -302,11 +497,18 @@ init (void)
   memset (res, 0, sizeof (*res));
   res->nodes_size = 2;
   res->nodes = (Node **) calloc (res->nodes_size, sizeof (Node *));
+  res->defs_size = 2;
+  res->defs = (Def **) calloc (res->defs_size, sizeof (Def *));
   res->buffer_size = 2;
   res->buffer = (char *) malloc (res->buffer_size);
+  res->saved_buffer_size = 2;
+  res->saved_buffer = (char *) malloc (res->saved_buffer_size);
   res->in = stdin;
   res->log = stderr;
   res->out = stdout;
+  res->max_decisions = -1;
+  res->time_limit = -1;
+  res->conflict_limit = -1;
 
   return res;
 }
@@ -323,12 +525,50 @@ connect_solver (Mgr * mgr)
 /*------------------------------------------------------------------------*/
 
 static void
-release (Mgr * mgr)
+release_queries (Mgr * mgr)
+{
+  Query *q, *next_query;
+
+  for (q = mgr->first_query; q; q = next_query)
+    {
+      next_query = q->next;
+      free (q->name);
+      free (q);
+    }
+
+  mgr->first_query = mgr->last_query = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+/* Remove all definitions but keep the nodes they are bound to.
+ */
+static void
+release_defs (Mgr * mgr)
+{
+  Def *d, *next_def;
+
+  for (d = mgr->first_def; d; d = next_def)
+    {
+      next_def = d->next_inserted;
+      d->node->def = 0;
+      free (d->name);
+      free (d);
+    }
+
+  memset (mgr->defs, 0, mgr->defs_size * sizeof (Def *));
+  mgr->defs_count = 0;
+  mgr->first_def = mgr->last_def = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+release_nodes (Mgr * mgr)
 {
   Node *p, *next;
 
-  if (mgr->limmat)
-    delete_Limmat (mgr->limmat);
+  release_defs (mgr);
 
   for (p = mgr->first; p; p = next)
     {
@@ -338,6 +578,18 @@ release (Mgr * mgr)
       free (p);
     }
 
+  release_queries (mgr);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+release (Mgr * mgr)
+{
+  if (mgr->limmat)
+    delete_Limmat (mgr->limmat);
+
+  release_nodes (mgr);
 
   if (mgr->close_in)
     fclose (mgr->in);
@@ -347,46 +599,95 @@ release (Mgr * mgr)
     fclose (mgr->log);
 
   free (mgr->idx2node);
+  free (mgr->model);
+  free (mgr->values);
+  free (mgr->error);
   free (mgr->nodes);
+  free (mgr->defs);
   free (mgr->buffer);
+  free (mgr->saved_buffer);
   free (mgr);
 }
 
 /*------------------------------------------------------------------------*/
+/* Prepare parsing a new input.  Nodes and definitions are kept.
+ */
+static void
+reset_parser (Mgr * mgr)
+{
+  mgr->x = 0;
+  mgr->y = 0;
+  mgr->last_y = 0;
+  mgr->saved_char_is_valid = 0;
+  mgr->saved_token_is_valid = 0;
+  mgr->root = 0;
+
+  free (mgr->error);
+  mgr->error = 0;
+}
 
+/*------------------------------------------------------------------------*/
+/* Remove all nodes, definitions and clauses, such that the manager can be
+ * used for a new input.  The hash tables, buffers and the solver are kept
+ * with their current size.
+ */
 static void
-print_token (Mgr * mgr)
+reset (Mgr * mgr)
+{
+  release_nodes (mgr);
+
+  memset (mgr->nodes, 0, mgr->nodes_size * sizeof (Node *));
+  mgr->nodes_count = 0;
+  mgr->first = mgr->last = 0;
+  mgr->encoded = 0;
+  mgr->idx = 0;
+
+  mgr->model_size = 0;
+  mgr->num_values = 0;
+
+  memset (mgr->nodes_by_type, 0, sizeof (mgr->nodes_by_type));
+  memset (mgr->clauses_by_type, 0, sizeof (mgr->clauses_by_type));
+  mgr->units = 0;
+  mgr->name_bytes = 0;
+
+  reset_parser (mgr);
+
+  if (mgr->limmat)
+    reset_Limmat (mgr->limmat);
+}
+
+/*------------------------------------------------------------------------*/
+
+static const char *
+token2str (Mgr * mgr)
 {
   switch (mgr->token)
     {
     case VAR:
-      fputs (mgr->buffer, mgr->log);
-      break;
+      return mgr->buffer;
     case LP:
-      fputc ('(', mgr->log);
-      break;
+      return "(";
     case RP:
-      fputc (')', mgr->log);
-      break;
+      return ")";
     case NOT:
-      fputc ('!', mgr->log);
-      break;
+      return "!";
     case AND:
-      fputc ('&', mgr->log);
-      break;
+      return "&";
     case OR:
-      fputc ('|', mgr->log);
-      break;
+      return "|";
     case IMPLIES:
-      fputs ("->", mgr->log);
-      break;
+      return "->";
     case IFF:
-      fputs ("<->", mgr->log);
-      break;
+      return "<->";
+    case DEF:
+      return ":=";
+    case SEMI:
+      return ";";
+    case COLON:
+      return ":";
     default:
       assert (mgr->token == DONE);
-      fputs ("EOF", mgr->log);
-      break;
+      return "EOF";
     }
 }
 
@@ -395,23 +696,47 @@ print_token (Mgr * mgr)
 static void
 parse_error (Mgr * mgr, const char *fmt, ...)
 {
+  const char *name;
+  int len, pos;
   va_list ap;
-  char *name;
 
   name = mgr->name ? mgr->name : "<stdin>";
-  fprintf (mgr->log, "%s:%u:%u: ", name, mgr->token_x + 1, mgr->token_y);
+
+  va_start (ap, fmt);
+  len = vsnprintf (0, 0, fmt, ap);
+  va_end (ap);
+
+  len += strlen (name) + 2 * 12 + 3;
   if (mgr->token == ERROR)
-    fputs ("scan error: ", mgr->log);
+    len += strlen ("scan error: ");
   else
-    {
-      fputs ("parse error at '", mgr->log);
-      print_token (mgr);
-      fputs ("' ", mgr->log);
-    }
+    len += strlen ("parse error at '' ") + strlen (token2str (mgr));
+
+  free (mgr->error);
+  mgr->error = (char *) malloc (len + 1);
+
+  pos = sprintf (mgr->error, "%s:%u:%u: ", name, mgr->token_x + 1,
+		 mgr->token_y);
+  if (mgr->token == ERROR)
+    pos += sprintf (mgr->error + pos, "scan error: ");
+  else
+    pos += sprintf (mgr->error + pos,
+		    "parse error at '%s' ", token2str (mgr));
+
   va_start (ap, fmt);
-  vfprintf (mgr->log, fmt, ap);
+  vsprintf (mgr->error + pos, fmt, ap);
   va_end (ap);
-  fputc ('\n', mgr->log);
+
+  /* The library interface has no log.  In batch mode several workers may
+   * report errors at the same time.
+   */
+  if (mgr->log)
+    {
+      flockfile (mgr->log);
+      fputs (mgr->error, mgr->log);
+      fputc ('\n', mgr->log);
+      funlockfile (mgr->log);
+    }
 }
 
 /*------------------------------------------------------------------------*/
@@ -461,6 +786,8 @@ next_char (Mgr * mgr)
       mgr->saved_char_is_valid = 0;
       res = mgr->saved_char;
     }
+  else if (mgr->text)
+    res = *mgr->text ? (unsigned char) *mgr->text++ : EOF;
   else
     res = fgetc (mgr->in);
 
@@ -496,11 +823,59 @@ unget_char (Mgr * mgr, int ch)
 
 /*------------------------------------------------------------------------*/
 
+static void
+swap_buffers (Mgr * mgr)
+{
+  unsigned tmp_size;
+  char *tmp;
+
+  tmp = mgr->buffer;
+  mgr->buffer = mgr->saved_buffer;
+  mgr->saved_buffer = tmp;
+
+  tmp_size = mgr->buffer_size;
+  mgr->buffer_size = mgr->saved_buffer_size;
+  mgr->saved_buffer_size = tmp_size;
+}
+
+/*------------------------------------------------------------------------*/
+/* Push back the current token.  The variable token in front of it has its
+ * name saved in 'saved_buffer' (see 'parse_definitions') and becomes the
+ * current token again.
+ */
+static void
+unget_token (Mgr * mgr, unsigned x, unsigned y)
+{
+  assert (!mgr->saved_token_is_valid);
+
+  mgr->saved_token = mgr->token;
+  mgr->saved_token_x = mgr->token_x;
+  mgr->saved_token_y = mgr->token_y;
+  mgr->saved_token_is_valid = 1;
+
+  swap_buffers (mgr);
+  mgr->token = VAR;
+  mgr->token_x = x;
+  mgr->token_y = y;
+}
+
+/*------------------------------------------------------------------------*/
+
 static void
 next_token (Mgr * mgr)
 {
   int ch;
 
+  if (mgr->saved_token_is_valid)
+    {
+      mgr->saved_token_is_valid = 0;
+      swap_buffers (mgr);
+      mgr->token = mgr->saved_token;
+      mgr->token_x = mgr->saved_token_x;
+      mgr->token_y = mgr->saved_token_y;
+      return;
+    }
+
   mgr->token = ERROR;
   ch = next_char (mgr);
 
@@ -558,6 +933,21 @@ RESTART_NEXT_TOKEN:
     {
       mgr->token = RP;
     }
+  else if (ch == ':')
+    {
+      ch = next_char (mgr);
+      if (ch == '=')
+	mgr->token = DEF;
+      else
+	{
+	  unget_char (mgr, ch);
+	  mgr->token = COLON;
+	}
+    }
+  else if (ch == ';')
+    {
+      mgr->token = SEMI;
+    }
   else if (is_var_letter (ch))
     {
       mgr->buffer_count = 0;
@@ -594,6 +984,7 @@ parse_basic (Mgr * mgr)
 {
   Node *child;
   Node *res;
+  Def *def;
 
   res = 0;
 
@@ -612,7 +1003,8 @@ parse_basic (Mgr * mgr)
     }
   else if (mgr->token == VAR)
     {
-      res = var (mgr, mgr->buffer);
+      def = *find_def (mgr, mgr->buffer);
+      res = def ? def->node : var (mgr, mgr->buffer);
       next_token (mgr);
     }
   else if (mgr->token != ERROR)
@@ -726,14 +1118,129 @@ parse_expr (Mgr * mgr)
 
 /*------------------------------------------------------------------------*/
 
+static void
+add_query (Mgr * mgr, char *name, Node * root)
+{
+  Query *q;
+
+  q = (Query *) malloc (sizeof (*q));
+  q->name = name;
+  q->root = root;
+  q->next = 0;
+
+  if (mgr->last_query)
+    mgr->last_query->next = q;
+  else
+    mgr->first_query = q;
+  mgr->last_query = q;
+}
+
+/*------------------------------------------------------------------------*/
+/* Definitions 'name := expr;' and queries 'name : expr;' precede the main
+ * formula.  Since the main formula may start with a variable as well, this
+ * is the only place where we have to look ahead one token.
+ */
 static int
-parse (Mgr * mgr)
+parse_statements (Mgr * mgr)
+{
+  unsigned x, y;
+  Node *node;
+  char *name;
+  Type type;
+
+  while (mgr->token == VAR)
+    {
+      x = mgr->token_x;
+      y = mgr->token_y;
+      swap_buffers (mgr);
+      next_token (mgr);
+
+      if (mgr->token == ERROR)
+	return 0;
+
+      if (mgr->token != DEF && mgr->token != COLON)
+	{
+	  unget_token (mgr, x, y);
+	  break;
+	}
+
+      type = mgr->token;
+
+      if (type == DEF)
+	{
+	  if (*find_def (mgr, mgr->saved_buffer))
+	    {
+	      parse_error (mgr, "'%s' already defined", mgr->saved_buffer);
+	      return 0;
+	    }
+
+	  if (*find (mgr, VAR, mgr->saved_buffer, 0))
+	    {
+	      parse_error (mgr,
+			   "'%s' already used as variable", mgr->saved_buffer);
+	      return 0;
+	    }
+	}
+
+      name = strdup (mgr->saved_buffer);
+      next_token (mgr);
+
+      if (!(node = parse_expr (mgr)))
+	{
+	  free (name);
+	  return 0;
+	}
+
+      if (mgr->token != SEMI)
+	{
+	  if (mgr->token != ERROR)
+	    parse_error (mgr, "expected ';'");
+	  free (name);
+	  return 0;
+	}
+
+      if (type == COLON)
+	add_query (mgr, name, node);
+      else if (*find (mgr, VAR, name, 0))
+	{
+	  parse_error (mgr, "'%s' used in its own definition", name);
+	  free (name);
+	  return 0;
+	}
+      else
+	define (mgr, name, node);
+
+      next_token (mgr);
+    }
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* An input with queries is a multi-query input and has no main formula.
+ */
+static int
+parse_input (Mgr * mgr)
 {
   next_token (mgr);
 
   if (mgr->token == ERROR)
     return 0;
 
+  if (!parse_statements (mgr))
+    return 0;
+
+  if (mgr->first_query)
+    {
+      if (mgr->token == DONE)
+	return 1;
+
+      if (mgr->token != ERROR)
+	parse_error (mgr, "expected definition, query or EOF");
+
+      return 0;
+    }
+
   if (!(mgr->root = parse_expr (mgr)))
     return 0;
 
@@ -746,6 +1253,22 @@ parse (Mgr * mgr)
   return 0;
 }
 
+/*------------------------------------------------------------------------*/
+/* The parse time includes lexing and hash consing.
+ */
+static int
+parse (Mgr * mgr)
+{
+  double start;
+  int res;
+
+  start = wall_clock ();
+  res = parse_input (mgr);
+  mgr->parse_time += wall_clock () - start;
+
+  return res;
+}
+
 /*------------------------------------------------------------------------*/
 
 static void
@@ -767,14 +1290,15 @@ unit_clause (Mgr * mgr, int a)
 static void
 binary_clause (Mgr * mgr, int a, int b)
 {
-  int clause[3];
+  int *clause;
+
+  clause = mgr->clauses + mgr->clauses_count;
+  mgr->clauses_count += 3;
 
   clause[0] = a;
   clause[1] = b;
   clause[2] = 0;
 
-  add_Limmat (mgr->limmat, clause);
-
   if (mgr->dump)
     fprintf (mgr->out, "%d %d 0\n", a, b);
 }
@@ -784,31 +1308,44 @@ binary_clause (Mgr * mgr, int a, int b)
 static void
 ternary_clause (Mgr * mgr, int a, int b, int c)
 {
-  int clause[4];
+  int *clause;
+
+  clause = mgr->clauses + mgr->clauses_count;
+  mgr->clauses_count += 4;
 
   clause[0] = a;
   clause[1] = b;
   clause[2] = c;
   clause[3] = 0;
 
-  add_Limmat (mgr->limmat, clause);
-
   if (mgr->dump)
     fprintf (mgr->out, "%d %d %d 0\n", a, b, c);
 }
 
 /*------------------------------------------------------------------------*/
-
+/* Only nodes inserted after the last call are encoded.  Since children are
+ * always inserted before their parents, the clauses of previously encoded
+ * nodes stay valid and can be shared by later formulas.  The clauses of all
+ * nodes are collected in one buffer and added to the solver at once.  They
+ * are well formed unless an operator has the same node as both children.
+ */
 static void
 tsetin (Mgr * mgr)
 {
-  int num_clauses;
+  int num_clauses, n, trusted;
+  unsigned num_ints;
+  double start;
+  Node *first;
   int sign;
   Node *p;
 
+  start = wall_clock ();
   num_clauses = 0;
+  num_ints = 0;
+  trusted = 1;
+  first = mgr->encoded ? mgr->encoded->next_inserted : mgr->first;
 
-  for (p = mgr->first; p; p = p->next_inserted)
+  for (p = first; p; p = p->next_inserted)
     {
       p->idx = ++mgr->idx;
 
@@ -818,30 +1355,46 @@ tsetin (Mgr * mgr)
       switch (p->type)
 	{
 	case IFF:
-	  num_clauses += 4;
+	  n = 4;
+	  num_ints += 4 * 4;
 	  break;
 	case OR:
 	case AND:
 	case IMPLIES:
-	  num_clauses += 3;
+	  n = 3;
+	  num_ints += 2 * 3 + 4;
 	  break;
 	case NOT:
-	  num_clauses += 2;
+	  n = 2;
+	  num_ints += 2 * 3;
 	  break;
 	default:
 	  assert (p->type == VAR);
+	  n = 0;
 	  break;
 	}
+
+      if (p->type >= AND && p->data.as_child[0] == p->data.as_child[1])
+	trusted = 0;
+
+      num_clauses += n;
+      mgr->clauses_by_type[p->type] += n;
     }
 
-  mgr->idx2node = (Node **) calloc (mgr->idx + 1, sizeof (Node *));
-  for (p = mgr->first; p; p = p->next_inserted)
+  mgr->idx2node = (Node **)
+    realloc (mgr->idx2node, (mgr->idx + 1) * sizeof (Node *));
+  mgr->idx2node[0] = 0;
+  for (p = first; p; p = p->next_inserted)
     mgr->idx2node[p->idx] = p;
 
   if (mgr->dump)
-    fprintf (mgr->out, "p cnf %d %u\n", mgr->idx, num_clauses + 1);
+    fprintf (mgr->out, "p cnf %d %u\n",
+	     mgr->idx, num_clauses + (mgr->root ? 1 : 0));
 
-  for (p = mgr->first; p; p = p->next_inserted)
+  mgr->clauses = (int *) malloc ((num_ints + 1) * sizeof (int));
+  mgr->clauses_count = 0;
+
+  for (p = first; p; p = p->next_inserted)
     {
       switch (p->type)
 	{
@@ -886,10 +1439,39 @@ tsetin (Mgr * mgr)
 	}
     }
 
-  assert (mgr->root);
+  assert (mgr->clauses_count == num_ints);
+
+  mgr->encode_time += wall_clock () - start;
+  start = wall_clock ();
+
+  add_clauses_Limmat (mgr->limmat, mgr->clauses, num_clauses, trusted);
+  free (mgr->clauses);
+  mgr->clauses = 0;
+
+  if (mgr->last)
+    mgr->encoded = mgr->last;
+
+  /* Queries are solved under assumptions instead.
+   */
+  if (mgr->root)
+    {
+      sign = (mgr->check_satisfiability) ? 1 : -1;
+      unit_clause (mgr, sign * mgr->root->idx);
+      mgr->units++;
+    }
+
+  mgr->add_time += wall_clock () - start;
+}
 
-  sign = (mgr->check_satisfiability) ? 1 : -1;
-  unit_clause (mgr, sign * mgr->root->idx);
+/*------------------------------------------------------------------------*/
+/* While pretty printing, a node bound to a definition printed before is
+ * referenced by name.  The definitions with index smaller than 'pp_limit'
+ * have already been printed.
+ */
+static int
+is_named (Mgr * mgr, Node * node)
+{
+  return node->def && node->def->idx < mgr->pp_limit;
 }
 
 /*------------------------------------------------------------------------*/
@@ -902,6 +1484,12 @@ pp_aux (Mgr * mgr, Node * node, Type outer)
   le = outer <= node->type;
   lt = outer < node->type;
 
+  if (is_named (mgr, node))
+    {
+      fputs (node->def->name, mgr->out);
+      return;
+    }
+
   switch (node->type)
     {
     case NOT:
@@ -942,7 +1530,7 @@ pp_aux (Mgr * mgr, Node * node, Type outer)
 static void
 pp_and (Mgr * mgr, Node * node)
 {
-  if (node->type == AND)
+  if (node->type == AND && !is_named (mgr, node))
     {
       pp_and (mgr, node->data.as_child[0]);
       fprintf (mgr->out, "\n&\n");
@@ -957,7 +1545,7 @@ pp_and (Mgr * mgr, Node * node)
 static void
 pp_or (Mgr * mgr, Node * node)
 {
-  if (node->type == OR)
+  if (node->type == OR && !is_named (mgr, node))
     {
       pp_or (mgr, node->data.as_child[0]);
       fprintf (mgr->out, "\n|\n");
@@ -988,7 +1576,7 @@ pp_and_or (Mgr * mgr, Node * node, Type outer)
 static void
 pp_iff_implies (Mgr * mgr, Node * node, Type outer)
 {
-  if (node->type == IFF || node->type == IMPLIES)
+  if ((node->type == IFF || node->type == IMPLIES) && !is_named (mgr, node))
     {
       pp_and_or (mgr, node->data.as_child[0], node->type);
       fprintf (mgr->out, "\n%s\n", node->type == IFF ? "<->" : "->");
@@ -1003,9 +1591,53 @@ pp_iff_implies (Mgr * mgr, Node * node, Type outer)
 static void
 pp (Mgr * mgr)
 {
-  assert (mgr->root);
-  pp_iff_implies (mgr, mgr->root, DONE);
-  fputc ('\n', mgr->out);
+  Query *q;
+  Def *d;
+
+  assert (mgr->root || mgr->first_query);
+
+  for (d = mgr->first_def; d; d = d->next_inserted)
+    {
+      mgr->pp_limit = d->idx;
+      fprintf (mgr->out, "%s := ", d->name);
+      pp_aux (mgr, d->node, DONE);
+      fputs (";\n", mgr->out);
+    }
+
+  mgr->pp_limit = mgr->defs_count;
+
+  for (q = mgr->first_query; q; q = q->next)
+    {
+      fprintf (mgr->out, "%s : ", q->name);
+      pp_aux (mgr, q->root, DONE);
+      fputs (";\n", mgr->out);
+    }
+
+  if (mgr->root)
+    {
+      pp_iff_implies (mgr, mgr->root, DONE);
+      fputc ('\n', mgr->out);
+    }
+}
+
+/*------------------------------------------------------------------------*/
+/* Only variables in the cone of influence of the checked formula are part
+ * of the printed assignment.  Nodes in the cone get the current stamp.
+ */
+static void
+mark_cone (Mgr * mgr, Node * node)
+{
+  if (node->mark == mgr->stamp)
+    return;
+
+  node->mark = mgr->stamp;
+
+  if (node->type != VAR)
+    {
+      mark_cone (mgr, node->data.as_child[0]);
+      if (node->data.as_child[1])
+	mark_cone (mgr, node->data.as_child[1]);
+    }
 }
 
 /*------------------------------------------------------------------------*/
@@ -1033,214 +1665,2559 @@ print_assignment (Mgr * mgr, const int *assignment)
       assert (idx <= mgr->idx);
 
       n = mgr->idx2node[idx];
-      if (n->type == VAR)
+      if (n->type == VAR && n->mark == mgr->stamp)
 	fprintf (mgr->out, "%s = %d\n", n->data.as_name, val);
     }
 }
 
 /*------------------------------------------------------------------------*/
+/* The result cache maps canonical fingerprints of formulas to the result
+ * of previous checks and, for satisfiable formulas, a satisfying
+ * assignment.  The fingerprint is a 128 bit Merkle hash over the type and
+ * the children of the nodes in the cone of the root.  Variables are hashed
+ * by the order in which they are reached in a depth first traversal, so
+ * formulas which only differ in the names of their variables, in white
+ * space or in redundant parentheses share their entry.
+ *
+ * The cache file is mapped into memory.  It consists of a header, an open
+ * addressing hash table of slots and the witnesses, which store one byte
+ * for each variable in canonical order.  Each slot has a checksum over its
+ * fields and its witness, which is checked before the slot is used.  New
+ * entries are kept in memory and the whole file is rewritten when the
+ * cache is closed.
+ */
+#define CACHE_MAGIC "LBCACHE2"
 
-#define USAGE \
-"usage: limboole [ <option> ... ]\n" \
-"\n" \
-"  -h             print this command line summary and exit\n" \
-"  --version      print the version and exit\n" \
-"  -v             increase verbosity\n" \
-"  -p             pretty print input formula only\n" \
-"  -d             dump generated CNF only\n" \
-"  -s             check satisfiability (default is to check validity)\n" \
-"  -m <max-dec>   maximal decision bound (default unbounded)\n" \
-"  -o <out-file>  set output file (default <stdout>)\n" \
-"  -l <log-file>  set log file (default <stderr>)\n" \
-"  <in-file>      input file (default <stdin>)\n"
+typedef struct CacheHeader CacheHeader;
+typedef struct CacheSlot CacheSlot;
+typedef struct CacheEntry CacheEntry;
+
+struct CacheHeader
+{
+  char magic[8];
+  unsigned num_slots;		/* power of two */
+  unsigned num_entries;
+  unsigned data_bytes;
+  unsigned reserved;
+};
+
+struct CacheSlot
+{
+  unsigned fingerprint[4];
+  unsigned result;		/* result plus one and zero if empty */
+  unsigned witness;		/* offset of witness in data section */
+  unsigned num_vars;
+  unsigned checksum;		/* over the fields above and the witness */
+};
+
+struct CacheEntry
+{
+  unsigned fingerprint[4];
+  unsigned result;
+  unsigned num_vars;
+  char *witness;
+  CacheEntry *next;
+};
+
+struct Cache
+{
+  char *path;
+  char *map;			/* mapped cache file or zero */
+  size_t map_size;
+  CacheHeader *header;
+  CacheSlot *slots;
+  char *data;
+  CacheEntry *entries;		/* new entries not written yet */
+  Node **cone;			/* cone of last formula in canonical order */
+  int cone_size;
+  int cone_capacity;
+  int num_vars;
+  unsigned *fingerprints;	/* four words per node of the cone */
+  signed char *values;		/* witness evaluated on the cone */
+  unsigned fingerprint[4];	/* of the last formula */
+  int hits;
+  int misses;
+};
 
 /*------------------------------------------------------------------------*/
+/* Finalizer of MurmurHash3.
+ */
+static unsigned
+mix (unsigned h)
+{
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
 
-int
-limboole (int argc, char **argv)
+  return h;
+}
+
+/*------------------------------------------------------------------------*/
+
+static const unsigned cache_seeds[4] = {
+  0x9e3779b9u, 0x7f4a7c15u, 0xf39cc060u, 0x5ced1e3du
+};
+
+/*------------------------------------------------------------------------*/
+
+static unsigned
+slot_checksum (const CacheSlot * slot, const char *witness)
 {
-  const int *assignment;
-  int max_decisions;
-  int pretty_print;
-  FILE *file;
-  int error;
-  Mgr *mgr;
-  int done;
-  int res;
-  int i;
+  unsigned h, i;
+
+  h = cache_seeds[0];
+  for (i = 0; i < 4; i++)
+    h = mix (h ^ slot->fingerprint[i]);
+  h = mix (h ^ slot->result);
+  h = mix (h ^ slot->witness);
+  h = mix (h ^ slot->num_vars);
+  for (i = 0; i < slot->num_vars; i++)
+    h = mix (h ^ (unsigned char) witness[i]);
+
+  return h;
+}
 
-  done = 0;
-  error = 0;
-  pretty_print = 0;
-  max_decisions = -1;
+/*------------------------------------------------------------------------*/
+/* Return the witness of a slot of the mapped cache file or zero if the
+ * slot is corrupted.
+ */
+static const char *
+valid_slot (Cache * cache, const CacheSlot * slot)
+{
+  const char *witness;
 
-  mgr = init ();
+  if (slot->witness > cache->header->data_bytes ||
+      slot->num_vars > cache->header->data_bytes - slot->witness)
+    return 0;
 
-  for (i = 1; !done && !error && i < argc; i++)
+  witness = cache->data + slot->witness;
+  if (slot_checksum (slot, witness) != slot->checksum)
+    return 0;
+
+  return witness;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+open_cache (Mgr * mgr, const char *path)
+{
+  CacheHeader *header;
+  struct stat buf;
+  Cache *cache;
+  size_t bytes;
+  char *map;
+  int fd;
+
+  cache = (Cache *) malloc (sizeof (*cache));
+  memset (cache, 0, sizeof (*cache));
+  cache->path = strdup (path);
+  mgr->cache = cache;
+
+  if ((fd = open (path, O_RDONLY)) < 0)
+    return;
+
+  map = 0;
+  if (!fstat (fd, &buf) && buf.st_size >= (off_t) sizeof (CacheHeader))
     {
-      if (!strcmp (argv[i], "-h"))
-	{
-	  fprintf (mgr->out, USAGE);
-	  done = 1;
-	}
-      else if (!strcmp (argv[i], "--version"))
-	{
-	  fprintf (mgr->out, "%s\n", VERSION);
-	  done = 1;
-	}
-      else if (!strcmp (argv[i], "-v"))
-	{
-	  mgr->verbose += 1;
-	}
-      else if (!strcmp (argv[i], "-p"))
-	{
-	  pretty_print = 1;
-	}
-      else if (!strcmp (argv[i], "-d"))
-	{
-	  mgr->dump = 1;
-	}
-      else if (!strcmp (argv[i], "-s"))
-	{
-	  mgr->check_satisfiability = 1;
-	}
-      else if (!strcmp (argv[i], "-m"))
-	{
-	  if (i == argc - 1)
-	    {
-	      fprintf (mgr->log, "*** argument to '-m' missing (try '-h')\n");
-	      error = 1;
-	    }
-	  else
-	    max_decisions = atoi (argv[++i]);
-	}
-      else if (!strcmp (argv[i], "-o"))
-	{
-	  if (i == argc - 1)
-	    {
-	      fprintf (mgr->log, "*** argument to '-o' missing (try '-h')\n");
-	      error = 1;
-	    }
-	  else if (!(file = fopen (argv[++i], "w")))
-	    {
-	      fprintf (mgr->log, "*** could not write '%s'\n", argv[i]);
-	      error = 1;
-	    }
-	  else if (mgr->close_out)
-	    {
-	      /* We moved this down for coverage in testing purposes */
-	      fclose (file);
-	      fprintf (mgr->log, "*** '-o' specified twice (try '-h')\n");
-	      error = 1;
-	    }
-	  else
-	    {
-	      mgr->out = file;
-	      mgr->close_out = 1;
-	    }
-	}
-      else if (!strcmp (argv[i], "-l"))
-	{
-	  if (i == argc - 1)
-	    {
-	      fprintf (mgr->log, "*** argument to '-l' missing (try '-h')\n");
-	      error = 1;
-	    }
-	  else if (!(file = fopen (argv[++i], "a")))
-	    {
-	      fprintf (mgr->log, "*** could not append to '%s'\n", argv[i]);
-	      error = 1;
-	    }
-	  else if (mgr->close_log)
-	    {
-	      /* We moved this down for coverage in testing purposes */
-	      fclose (file);
-	      fprintf (mgr->log, "*** '-l' specified twice (try '-h')\n");
-	      error = 1;
-	    }
-	  else
-	    {
-	      mgr->log = file;
-	      mgr->close_log = 1;
-	    }
-	}
-      else if (argv[i][0] == '-')
-	{
-	  fprintf (mgr->log,
-		   "*** invalid command line option '%s' (try '-h')\n",
-		   argv[i]);
-	  error = 1;
-	}
-      else if (mgr->close_in)
-	{
-	  fprintf (mgr->log,
-		   "*** can not read more than two files (try '-h')\n");
-	  error = 1;
-	}
-      else if (!(file = fopen (argv[i], "r")))
-	{
-	  fprintf (mgr->log, "*** could not read '%s'\n", argv[i]);
-	  error = 1;
-	}
-      else
+      map = (char *) mmap (0, buf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (map == (char *) MAP_FAILED)
+	map = 0;
+    }
+
+  close (fd);
+
+  header = (CacheHeader *) map;
+  if (header)
+    {
+      bytes = sizeof (CacheHeader);
+      bytes += header->num_slots * (size_t) sizeof (CacheSlot);
+      bytes += header->data_bytes;
+
+      if (!memcmp (header->magic, CACHE_MAGIC, 8) &&
+	  header->num_slots &&
+	  !(header->num_slots & (header->num_slots - 1)) &&
+	  header->num_entries < header->num_slots &&
+	  bytes == (size_t) buf.st_size)
 	{
-	  mgr->in = file;
-	  mgr->name = argv[i];
-	  mgr->close_in = 1;
+	  cache->map = map;
+	  cache->map_size = bytes;
+	  cache->header = header;
+	  cache->slots = (CacheSlot *) (header + 1);
+	  cache->data = (char *) (cache->slots + header->num_slots);
+	  return;
 	}
+
+      munmap (map, buf.st_size);
     }
 
-  if (!error && !done)
+  fprintf (mgr->log, "*** ignoring invalid cache '%s'\n", path);
+}
+
+/*------------------------------------------------------------------------*/
+/* Number the nodes in the cone of 'node' in depth first post order and
+ * compute their fingerprints.  The variables are hashed by their number in
+ * the order they are reached, not by their names.
+ */
+static void
+canonize (Mgr * mgr, Node * node)
+{
+  unsigned *fingerprint, *c0, *c1;
+  Cache *cache;
+  unsigned h;
+  int i;
+
+  if (node->mark == mgr->stamp)
+    return;
+
+  node->mark = mgr->stamp;
+
+  c0 = c1 = 0;
+  cache = mgr->cache;
+
+  if (node->type != VAR)
     {
-      error = !parse (mgr);
+      canonize (mgr, node->data.as_child[0]);
+      c0 = cache->fingerprints + 4 * node->data.as_child[0]->canonical;
 
-      if (!error)
+      if (node->data.as_child[1])
 	{
-	  if (pretty_print)
-	    pp (mgr);
-	  else
-	    {
-	      connect_solver (mgr);
-	      tsetin (mgr);
-	      if (!mgr->dump)
-		{
-		  if (mgr->verbose)
-		    set_log_Limmat (mgr->limmat, mgr->log);
-
-		  res = sat_Limmat (mgr->limmat, max_decisions);
-
-		  if (res < 0)
-		    {
-		      fprintf (mgr->out, "%% RESOURCES EXHAUSTED\n");
-		      error = 1;
-		    }
-		  else if (res == 1)
-		    {
-		      if (mgr->check_satisfiability)
-			fprintf (mgr->out,
-				 "%% SATISFIABLE formula"
-				 " (satisfying assignment follows)\n");
-		      else
-			fprintf (mgr->out,
-				 "%% INVALID formula"
-				 " (falsifying assignment follows)\n");
-
-		      assignment = assignment_Limmat (mgr->limmat);
-		      print_assignment (mgr, assignment);
-		    }
-		  else
-		    {
-		      if (mgr->check_satisfiability)
-			fprintf (mgr->out, "%% UNSATISFIABLE formula\n");
-		      else
-			fprintf (mgr->out, "%% VALID formula\n");
-		    }
-		}
-	    }
+	  canonize (mgr, node->data.as_child[1]);
+	  c1 = cache->fingerprints + 4 * node->data.as_child[1]->canonical;
 	}
     }
 
-  release (mgr);
+  if (cache->cone_size == cache->cone_capacity)
+    {
+      cache->cone_capacity = cache->cone_capacity ?
+	2 * cache->cone_capacity : 16;
+      cache->cone = (Node **)
+	realloc (cache->cone, cache->cone_capacity * sizeof (Node *));
+      cache->fingerprints = (unsigned *)
+	realloc (cache->fingerprints,
+		 4 * cache->cone_capacity * sizeof (unsigned));
+      cache->values = (signed char *)
+	realloc (cache->values, cache->cone_capacity);
+    }
 
-  return error != 0;
+  node->canonical = cache->cone_size++;
+  cache->cone[node->canonical] = node;
+  fingerprint = cache->fingerprints + 4 * node->canonical;
+
+  for (i = 0; i < 4; i++)
+    {
+      h = mix (cache_seeds[i] + (unsigned) node->type);
+
+      if (node->type == VAR)
+	h = mix (h ^ mix ((unsigned) cache->num_vars + cache_seeds[i]));
+
+      if (c0)
+	h = mix (h ^ c0[i]);
+
+      if (c1)
+	h = mix (h * 5 + c1[(i + 1) & 3]);
+
+      fingerprint[i] = h;
+    }
+
+  if (node->type == VAR)
+    cache->num_vars++;
+}
+
+/*------------------------------------------------------------------------*/
+/* Compute the fingerprint of checking 'root' in the current mode.
+ */
+static void
+fingerprint (Mgr * mgr, Node * root)
+{
+  Cache *cache;
+  unsigned *p;
+  int i;
+
+  cache = mgr->cache;
+  cache->cone_size = 0;
+  cache->num_vars = 0;
+
+  mgr->stamp++;
+  canonize (mgr, root);
+
+  p = cache->fingerprints + 4 * root->canonical;
+  for (i = 0; i < 4; i++)
+    cache->fingerprint[i] = mix (p[i] + mgr->check_satisfiability + 1);
+}
+
+/*------------------------------------------------------------------------*/
+/* Evaluate the cone of the last formula under the witness.  Variables are
+ * stored in canonical order, which is the order of the cone.
+ */
+static int
+evaluate_witness (Mgr * mgr, const char *witness)
+{
+  signed char *values, a, b;
+  Cache *cache;
+  Node *node;
+  int i, j;
+
+  cache = mgr->cache;
+  values = cache->values;
+
+  for (i = j = 0; i < cache->cone_size; i++)
+    {
+      node = cache->cone[i];
+
+      if (node->type == VAR)
+	{
+	  values[i] = (witness[j++] != 0);
+	  continue;
+	}
+
+      a = values[node->data.as_child[0]->canonical];
+      b = node->data.as_child[1] ?
+	values[node->data.as_child[1]->canonical] : 0;
+
+      switch (node->type)
+	{
+	case AND:
+	  values[i] = a && b;
+	  break;
+	case OR:
+	  values[i] = a || b;
+	  break;
+	case IMPLIES:
+	  values[i] = !a || b;
+	  break;
+	case IFF:
+	  values[i] = (a == b);
+	  break;
+	default:
+	  assert (node->type == NOT);
+	  values[i] = !a;
+	  break;
+	}
+    }
+
+  return values[cache->cone_size - 1];
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+match_fingerprint (const unsigned *a, const unsigned *b)
+{
+  return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+}
+
+/*------------------------------------------------------------------------*/
+/* Look up the result of checking 'root'.  A cached witness is only used if
+ * it actually satisfies respectively falsifies the formula.
+ */
+static int
+lookup_cache (Mgr * mgr, Node * root, int *res_ptr)
+{
+  const char *witness, *data;
+  unsigned result, num_vars, mask, i, j;
+  CacheEntry *entry;
+  CacheSlot *slot;
+  Cache *cache;
+  int expected;
+
+  cache = mgr->cache;
+  fingerprint (mgr, root);
+
+  witness = 0;
+  result = 0;
+  num_vars = 0;
+
+  for (entry = cache->entries; !result && entry; entry = entry->next)
+    if (match_fingerprint (entry->fingerprint, cache->fingerprint))
+      {
+	result = entry->result;
+	num_vars = entry->num_vars;
+	witness = entry->witness;
+      }
+
+  if (!result && cache->header)
+    {
+      /* A corrupted file may not have any empty slot.
+       */
+      mask = cache->header->num_slots - 1;
+      for (i = cache->fingerprint[0] & mask, j = 0;
+	   j <= mask && (slot = cache->slots + i)->result;
+	   i = (i + 1) & mask, j++)
+	if (match_fingerprint (slot->fingerprint, cache->fingerprint))
+	  {
+	    if ((data = valid_slot (cache, slot)))
+	      {
+		result = slot->result;
+		num_vars = slot->num_vars;
+		witness = data;
+	      }
+	    break;
+	  }
+    }
+
+  expected = mgr->check_satisfiability ? 1 : 0;
+
+  if (result == 2 &&
+      (num_vars != (unsigned) cache->num_vars ||
+       evaluate_witness (mgr, witness) != expected))
+    result = 0;
+
+  if (result != 1 && result != 2)
+    {
+      cache->misses++;
+      return 0;
+    }
+
+  cache->hits++;
+  *res_ptr = result - 1;
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* Remember the result of the last formula, for which 'lookup_cache' has
+ * been called.  The witness is taken from the assignment of the solver.
+ */
+static void
+insert_cache (Mgr * mgr, int res, const int *assignment)
+{
+  CacheEntry *entry;
+  const int *p;
+  Cache *cache;
+  Node *node;
+  int i, j;
+
+  cache = mgr->cache;
+
+  entry = (CacheEntry *) malloc (sizeof (*entry));
+  memcpy (entry->fingerprint, cache->fingerprint, sizeof (entry->fingerprint));
+  entry->result = res + 1;
+  entry->num_vars = res ? cache->num_vars : 0;
+  entry->witness = (char *) malloc (entry->num_vars + 1);
+  entry->next = cache->entries;
+  cache->entries = entry;
+
+  if (!res)
+    return;
+
+  for (i = 0; i < cache->cone_size; i++)
+    cache->values[i] = 0;
+
+  for (p = assignment; *p; p++)
+    {
+      node = mgr->idx2node[abs (*p)];
+      if (node->mark == mgr->stamp && node->type == VAR)
+	cache->values[node->canonical] = (*p > 0);
+    }
+
+  for (i = j = 0; i < cache->cone_size; i++)
+    if (cache->cone[i]->type == VAR)
+      entry->witness[j++] = cache->values[i];
+}
+
+/*------------------------------------------------------------------------*/
+/* Store an entry unless there is already one with the same fingerprint.
+ * The witness is stored at offset 'witness' of 'data' by the caller.
+ */
+static int
+store_slot (CacheSlot * slots, unsigned num_slots,
+	    const unsigned *fingerprint, unsigned result,
+	    unsigned witness, unsigned num_vars, const char *data)
+{
+  unsigned i, mask;
+
+  mask = num_slots - 1;
+  for (i = fingerprint[0] & mask; slots[i].result; i = (i + 1) & mask)
+    if (match_fingerprint (slots[i].fingerprint, fingerprint))
+      return 0;
+
+  memcpy (slots[i].fingerprint, fingerprint, sizeof (slots[i].fingerprint));
+  slots[i].result = result;
+  slots[i].witness = witness;
+  slots[i].num_vars = num_vars;
+  slots[i].checksum = slot_checksum (slots + i, data);
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* Write the new and the old entries to a unique temporary file in the
+ * directory of the cache, which then atomically replaces the cache file.
+ * New entries are stored first and thus replace old entries with the same
+ * fingerprint, e.g. if the old witness turned out to be invalid.  Old
+ * slots with a wrong checksum are dropped.
+ */
+static void
+write_cache (Mgr * mgr)
+{
+  unsigned num_slots, num_entries, data_bytes, j;
+  const char *witness;
+  CacheHeader header;
+  CacheEntry *entry;
+  CacheSlot *slots;
+  Cache *cache;
+  CacheSlot *s;
+  char *data;
+  char *tmp;
+  FILE *file;
+  int fd;
+
+  cache = mgr->cache;
+
+  num_entries = 0;
+  data_bytes = 0;
+  for (entry = cache->entries; entry; entry = entry->next)
+    {
+      num_entries++;
+      data_bytes += entry->num_vars;
+    }
+
+  if (cache->header)
+    {
+      num_entries += cache->header->num_entries;
+      data_bytes += cache->header->data_bytes;
+    }
+
+  num_slots = 64;
+  while (num_slots < 2 * num_entries)
+    num_slots *= 2;
+
+  slots = (CacheSlot *) calloc (num_slots, sizeof (CacheSlot));
+  data = (char *) malloc (data_bytes + 1);
+
+  num_entries = 0;
+  data_bytes = 0;
+
+  for (entry = cache->entries; entry; entry = entry->next)
+    if (store_slot (slots, num_slots, entry->fingerprint,
+		    entry->result, data_bytes, entry->num_vars,
+		    entry->witness))
+      {
+	memcpy (data + data_bytes, entry->witness, entry->num_vars);
+	data_bytes += entry->num_vars;
+	num_entries++;
+      }
+
+  if (cache->header)
+    for (j = 0; j < cache->header->num_slots; j++)
+      {
+	s = cache->slots + j;
+
+	if (!s->result || !(witness = valid_slot (cache, s)))
+	  continue;
+
+	if (store_slot (slots, num_slots, s->fingerprint,
+			s->result, data_bytes, s->num_vars, witness))
+	  {
+	    memcpy (data + data_bytes, witness, s->num_vars);
+	    data_bytes += s->num_vars;
+	    num_entries++;
+	  }
+      }
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, CACHE_MAGIC, 8);
+  header.num_slots = num_slots;
+  header.num_entries = num_entries;
+  header.data_bytes = data_bytes;
+
+  tmp = (char *) malloc (strlen (cache->path) + 8);
+  sprintf (tmp, "%s.XXXXXX", cache->path);
+
+  file = 0;
+  if ((fd = mkstemp (tmp)) >= 0)
+    {
+      fchmod (fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+      if (!(file = fdopen (fd, "w")))
+	{
+	  close (fd);
+	  unlink (tmp);
+	}
+    }
+
+  if (file)
+    {
+      fwrite (&header, sizeof (header), 1, file);
+      fwrite (slots, sizeof (CacheSlot), num_slots, file);
+      fwrite (data, 1, data_bytes, file);
+
+      if (fclose (file) || rename (tmp, cache->path))
+	{
+	  fprintf (mgr->log, "*** could not write cache '%s'\n", cache->path);
+	  unlink (tmp);
+	}
+    }
+  else
+    fprintf (mgr->log, "*** could not write cache '%s'\n", cache->path);
+
+  free (tmp);
+  free (data);
+  free (slots);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+close_cache (Mgr * mgr)
+{
+  CacheEntry *entry, *next;
+  Cache *cache;
+
+  cache = mgr->cache;
+
+  if (cache->entries)
+    write_cache (mgr);
+
+  if (mgr->verbose)
+    fprintf (mgr->log, "c cache %d hits %d misses\n",
+	     cache->hits, cache->misses);
+
+  for (entry = cache->entries; entry; entry = next)
+    {
+      next = entry->next;
+      free (entry->witness);
+      free (entry);
+    }
+
+  if (cache->map)
+    munmap (cache->map, cache->map_size);
+
+  free (cache->cone);
+  free (cache->fingerprints);
+  free (cache->values);
+  free (cache->path);
+  free (cache);
+
+  mgr->cache = 0;
+}
+
+/*------------------------------------------------------------------------*/
+/* Print the witness of a cache hit in the same order as the assignment of
+ * the solver would be printed, which is the order of insertion.
+ */
+static void
+print_cached_assignment (Mgr * mgr)
+{
+  Node *n;
+
+  for (n = mgr->first; n; n = n->next_inserted)
+    if (n->type == VAR && n->mark == mgr->stamp)
+      fprintf (mgr->out, "%s = %d\n",
+	       n->data.as_name, mgr->cache->values[n->canonical]);
+}
+/*------------------------------------------------------------------------*/
+
+static void
+set_limits (Mgr * mgr)
+{
+  set_time_limit_Limmat (mgr->limmat, mgr->time_limit);
+  set_conflict_limit_Limmat (mgr->limmat, mgr->conflict_limit);
+  set_memory_limit_Limmat (mgr->limmat, mgr->memory_limit);
+}
+
+/*------------------------------------------------------------------------*/
+/* Connect the solver and encode the nodes not encoded yet.  This is delayed
+ * until the first formula is not found in the cache.
+ */
+static void
+encode (Mgr * mgr)
+{
+  if (!mgr->limmat)
+    {
+      connect_solver (mgr);
+      set_limits (mgr);
+      if (mgr->verbose)
+	set_log_Limmat (mgr->limmat, mgr->log);
+    }
+
+  if (mgr->encoded != mgr->last)
+    tsetin (mgr);
+}
+
+/*------------------------------------------------------------------------*/
+/* Check the formula rooted at 'root' and return the result of the solver.
+ * Queries are checked by assuming their root, while the root of a single
+ * formula is already added as unit clause by 'tsetin'.
+ */
+static int
+check (Mgr * mgr, Node * root, int assume, int max_decisions)
+{
+  double start;
+  int sign;
+  int res;
+
+  if (assume)
+    {
+      sign = (mgr->check_satisfiability) ? 1 : -1;
+      assume_Limmat (mgr->limmat, sign * root->idx);
+    }
+
+  start = wall_clock ();
+  res = sat_Limmat (mgr->limmat, max_decisions);
+  mgr->solve_time += wall_clock () - start;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Check the formula rooted at 'root' and report the result.  The result is
+ * the result of the solver, which is negative if the resources are
+ * exhausted.
+ */
+static int
+solve (Mgr * mgr, Node * root, int assume, int max_decisions)
+{
+  const int *assignment;
+  int res;
+
+  assignment = 0;
+
+  if (!mgr->cache || !lookup_cache (mgr, root, &res))
+    {
+      encode (mgr);
+      res = check (mgr, root, assume, max_decisions);
+
+      if (res == 1)
+	assignment = assignment_Limmat (mgr->limmat);
+
+      if (mgr->cache && res >= 0)
+	insert_cache (mgr, res, assignment);
+    }
+
+  if (res < 0)
+    {
+      fprintf (mgr->out, "%% RESOURCES EXHAUSTED\n");
+      mgr->exhausted = 1;
+    }
+  else if (res == 1)
+    {
+      if (mgr->check_satisfiability)
+	fprintf (mgr->out,
+		 "%% SATISFIABLE formula (satisfying assignment follows)\n");
+      else
+	fprintf (mgr->out,
+		 "%% INVALID formula (falsifying assignment follows)\n");
+
+      mgr->stamp++;
+      mark_cone (mgr, root);
+
+      if (assignment)
+	print_assignment (mgr, assignment);
+      else
+	print_cached_assignment (mgr);
+    }
+  else
+    {
+      if (mgr->check_satisfiability)
+	fprintf (mgr->out, "%% UNSATISFIABLE formula\n");
+      else
+	fprintf (mgr->out, "%% VALID formula\n");
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Check the formula under each scenario of the file 'path'.  A scenario is
+ * a block of lines '<var> = 0' or '<var> = 1'.  Scenarios are separated by
+ * empty lines and lines starting with '%' are comments.  The formula is
+ * encoded once and all scenarios are solved as assumptions by the same
+ * solver, which keeps the clauses learned for previous scenarios.
+ */
+static int
+scenarios (Mgr * mgr, const char *path, int max_decisions)
+{
+  int num_scenarios, num_literals, size_literals, lineno, invalid, res;
+  char *line, *name, *value, *end;
+  int *literals;
+  size_t size;
+  FILE *file;
+  Query *q;
+  Node *n;
+  int i;
+
+  if (!(file = fopen (path, "r")))
+    {
+      fprintf (mgr->log, "*** could not read '%s'\n", path);
+      return 0;
+    }
+
+  encode (mgr);
+
+  res = 1;
+  line = 0;
+  size = 0;
+  lineno = 0;
+  invalid = 0;
+  num_scenarios = 0;
+  num_literals = 0;
+  size_literals = 0;
+  literals = 0;
+
+  for (;;)
+    {
+      name = 0;
+      if (getline (&line, &size, file) > 0)
+	{
+	  lineno++;
+	  name = line;
+	  while (isspace ((int) *name))
+	    name++;
+	}
+
+      if (name && *name == '%')
+	continue;
+
+      if (name && *name)
+	{
+	  for (end = name; *end && *end != '=' && !isspace ((int) *end);
+	       end++)
+	    ;
+
+	  value = end;
+	  while (isspace ((int) *value))
+	    value++;
+
+	  if (*value == '=')
+	    {
+	      *end = 0;
+	      value++;
+	      while (isspace ((int) *value))
+		value++;
+	    }
+	  else
+	    value = 0;
+
+	  if (!value || (*value != '0' && *value != '1') ||
+	      (value[1] && !isspace ((int) value[1])))
+	    {
+	      fprintf (mgr->log,
+		       "%s:%d: expected '<var> = 0' or '<var> = 1'\n",
+		       path, lineno);
+	      invalid = 1;
+	    }
+	  else if (!(n = *find (mgr, VAR, name, 0)))
+	    {
+	      fprintf (mgr->log, "%s:%d: unknown variable '%s'\n",
+		       path, lineno, name);
+	      invalid = 1;
+	    }
+	  else
+	    {
+	      if (num_literals == size_literals)
+		{
+		  size_literals = size_literals ? 2 * size_literals : 16;
+		  literals = (int *)
+		    realloc (literals, size_literals * sizeof (int));
+		}
+
+	      literals[num_literals++] = (*value == '1') ? n->idx : -n->idx;
+	    }
+
+	  continue;
+	}
+
+      /* An empty line or the end of the file ends the current scenario.
+       */
+      if (num_literals || invalid)
+	{
+	  fprintf (mgr->out, "%% scenario %d\n", ++num_scenarios);
+
+	  if (invalid)
+	    res = 0;
+	  else
+	    {
+	      if (mgr->root)
+		{
+		  for (i = 0; i < num_literals; i++)
+		    assume_Limmat (mgr->limmat, literals[i]);
+
+		  if (solve (mgr, mgr->root, 0, max_decisions) < 0)
+		    res = 0;
+		}
+
+	      for (q = mgr->first_query; q; q = q->next)
+		{
+		  for (i = 0; i < num_literals; i++)
+		    assume_Limmat (mgr->limmat, literals[i]);
+
+		  fprintf (mgr->out, "%% %s\n", q->name);
+		  if (solve (mgr, q->root, 1, max_decisions) < 0)
+		    res = 0;
+		}
+	    }
+
+	  num_literals = 0;
+	  invalid = 0;
+	}
+
+      if (!name)
+	break;
+    }
+
+  free (literals);
+  free (line);
+  fclose (file);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* In batch mode the files are checked by a pool of worker threads.  Each
+ * worker owns a range of file indices, which it works off from the head.
+ * A worker without work steals the upper half of the range of another
+ * worker.  Since runtimes vary a lot this keeps all workers busy until the
+ * very end.  Each worker uses its own manager and solver for each file.
+ */
+typedef struct Batch Batch;
+typedef struct Worker Worker;
+
+struct Worker
+{
+  Batch *batch;
+  pthread_t thread;
+  pthread_mutex_t lock;		/* protects 'head' and 'tail' */
+  int head;			/* next file to be checked */
+  int tail;			/* one after the last file to be checked */
+};
+
+struct Batch
+{
+  char **files;
+  int num_files;
+  int size_files;
+  Worker *workers;
+  int num_workers;
+  pthread_mutex_t lock;		/* serializes output and 'failed' */
+  FILE *out;
+  FILE *log;
+  int check_satisfiability;
+  int max_decisions;
+  double time_limit;
+  int conflict_limit;
+  size_t memory_limit;
+  int failed;
+};
+
+
+/*------------------------------------------------------------------------*/
+
+static const char *
+status (int check_satisfiability, int res)
+{
+  if (res < 0)
+    return "EXHAUSTED";
+
+  if (res)
+    return check_satisfiability ? "SATISFIABLE" : "INVALID";
+
+  return check_satisfiability ? "UNSATISFIABLE" : "VALID";
+}
+
+/*------------------------------------------------------------------------*/
+/* Print one result line of the form '<file>[:<query>] <status> <seconds>
+ * <bytes>'.  The time is the wall clock time spent on the file so far and
+ * the number of bytes is the maximal memory used by the solver.
+ */
+static void
+print_result (Batch * batch, Mgr * mgr, const char *name,
+	      Query * query, const char *status, double start)
+{
+  size_t bytes;
+
+  bytes = mgr->limmat ? max_bytes_Limmat (mgr->limmat) : 0;
+
+  pthread_mutex_lock (&batch->lock);
+  fputs (name, batch->out);
+  if (query)
+    fprintf (batch->out, ":%s", query->name);
+  fprintf (batch->out, " %s %.2f %lu\n",
+	   status, wall_clock () - start, (unsigned long) bytes);
+  fflush (batch->out);
+  if (!strcmp (status, "ERROR") || !strcmp (status, "EXHAUSTED"))
+    batch->failed = 1;
+  pthread_mutex_unlock (&batch->lock);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+check_file (Batch * batch, char *name)
+{
+  double start;
+  Query *q;
+  Mgr *mgr;
+  int res;
+
+  start = wall_clock ();
+  mgr = init ();
+  mgr->log = batch->log;
+  mgr->name = name;
+  mgr->check_satisfiability = batch->check_satisfiability;
+
+  if (!(mgr->in = fopen (name, "r")))
+    {
+      mgr->in = stdin;
+      print_result (batch, mgr, name, 0, "ERROR", start);
+    }
+  else
+    {
+      mgr->close_in = 1;
+
+      if (!parse (mgr))
+	print_result (batch, mgr, name, 0, "ERROR", start);
+      else
+	{
+	  mgr->time_limit = batch->time_limit;
+	  mgr->conflict_limit = batch->conflict_limit;
+	  mgr->memory_limit = batch->memory_limit;
+	  encode (mgr);
+
+	  if (mgr->root)
+	    {
+	      res = check (mgr, mgr->root, 0, batch->max_decisions);
+	      print_result (batch, mgr, name, 0,
+			    status (mgr->check_satisfiability, res), start);
+	    }
+
+	  for (q = mgr->first_query; q; q = q->next)
+	    {
+	      res = check (mgr, q->root, 1, batch->max_decisions);
+	      print_result (batch, mgr, name, q,
+			    status (mgr->check_satisfiability, res), start);
+	    }
+	}
+    }
+
+  release (mgr);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+next_file (Worker * worker)
+{
+  int res;
+
+  pthread_mutex_lock (&worker->lock);
+  if (worker->head < worker->tail)
+    res = worker->head++;
+  else
+    res = -1;
+  pthread_mutex_unlock (&worker->lock);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Steal the upper half of the range of the first other worker with files
+ * left, check the first stolen file and keep the rest as own range.
+ */
+static int
+steal_file (Worker * worker)
+{
+  int i, n, mid, tail, res;
+  Worker *victim;
+  Batch *batch;
+
+  batch = worker->batch;
+  n = batch->num_workers;
+  res = -1;
+
+  for (i = 1; res < 0 && i < n; i++)
+    {
+      victim = batch->workers + ((worker - batch->workers) + i) % n;
+
+      pthread_mutex_lock (&victim->lock);
+      tail = victim->tail;
+      if (victim->head < tail)
+	{
+	  mid = victim->head + (tail - victim->head) / 2;
+	  victim->tail = mid;
+	  res = mid;
+	}
+      pthread_mutex_unlock (&victim->lock);
+    }
+
+  if (res >= 0)
+    {
+      pthread_mutex_lock (&worker->lock);
+      worker->head = res + 1;
+      worker->tail = tail;
+      pthread_mutex_unlock (&worker->lock);
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void *
+work (void *arg)
+{
+  Worker *worker;
+  Batch *batch;
+  int i;
+
+  worker = (Worker *) arg;
+  batch = worker->batch;
+
+  while ((i = next_file (worker)) >= 0 || (i = steal_file (worker)) >= 0)
+    check_file (batch, batch->files[i]);
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+add_file (Batch * batch, const char *name)
+{
+  if (batch->size_files <= batch->num_files)
+    {
+      batch->size_files = batch->size_files ? 2 * batch->size_files : 16;
+      batch->files = (char **)
+	realloc (batch->files, batch->size_files * sizeof (char *));
+    }
+
+  batch->files[batch->num_files++] = strdup (name);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+cmp_files (const void *a, const void *b)
+{
+  return strcmp (*(char **) a, *(char **) b);
+}
+
+/*------------------------------------------------------------------------*/
+/* The files of a batch are either given as all regular files in a
+ * directory, which are sorted by name, or listed in a file one per line.
+ * Empty lines and lines starting with '%' are skipped in a list.
+ */
+static int
+read_files (Batch * batch, const char *path)
+{
+  struct dirent *entry;
+  struct stat buf;
+  char *name;
+  FILE *file;
+  DIR *dir;
+  int len;
+  int ch;
+
+  if ((dir = opendir (path)))
+    {
+      while ((entry = readdir (dir)))
+	{
+	  if (entry->d_name[0] == '.')
+	    continue;
+
+	  name = (char *) malloc (strlen (path) + strlen (entry->d_name) + 2);
+	  sprintf (name, "%s/%s", path, entry->d_name);
+	  if (!stat (name, &buf) && S_ISREG (buf.st_mode))
+	    add_file (batch, name);
+	  free (name);
+	}
+
+      closedir (dir);
+      qsort (batch->files, batch->num_files, sizeof (char *), cmp_files);
+
+      return 1;
+    }
+
+  if (!(file = fopen (path, "r")))
+    return 0;
+
+  len = 0;
+  name = (char *) malloc (2);
+  while ((ch = getc (file)) != EOF)
+    {
+      if (ch == '\n')
+	{
+	  while (len > 0 && isspace ((int) name[len - 1]))
+	    len--;
+	  name[len] = 0;
+	  if (len && name[0] != '%')
+	    add_file (batch, name);
+	  len = 0;
+	}
+      else
+	{
+	  name = (char *) realloc (name, len + 2);
+	  name[len++] = ch;
+	}
+    }
+
+  name[len] = 0;
+  if (len && name[0] != '%')
+    add_file (batch, name);
+
+  free (name);
+  fclose (file);
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+batch (Mgr * mgr, const char *path, int num_workers,
+       int max_decisions, double time_limit)
+{
+  Worker *worker;
+  Batch batch;
+  int i, res;
+
+  memset (&batch, 0, sizeof (batch));
+  batch.out = mgr->out;
+  batch.log = mgr->log;
+  batch.check_satisfiability = mgr->check_satisfiability;
+  batch.max_decisions = max_decisions;
+  batch.time_limit = time_limit;
+  batch.conflict_limit = mgr->conflict_limit;
+  batch.memory_limit = mgr->memory_limit;
+
+  if (!read_files (&batch, path))
+    {
+      fprintf (mgr->log, "*** could not read '%s'\n", path);
+      return 0;
+    }
+
+  if (num_workers > batch.num_files)
+    num_workers = batch.num_files;
+
+  batch.num_workers = num_workers;
+  batch.workers = (Worker *) calloc (num_workers, sizeof (Worker));
+  pthread_mutex_init (&batch.lock, 0);
+
+  for (i = 0; i < num_workers; i++)
+    {
+      worker = batch.workers + i;
+      worker->batch = &batch;
+      worker->head = (i * batch.num_files) / num_workers;
+      worker->tail = ((i + 1) * batch.num_files) / num_workers;
+      pthread_mutex_init (&worker->lock, 0);
+    }
+
+  for (i = 0; i < num_workers; i++)
+    pthread_create (&batch.workers[i].thread, 0, work, batch.workers + i);
+
+  for (i = 0; i < num_workers; i++)
+    {
+      pthread_join (batch.workers[i].thread, 0);
+      pthread_mutex_destroy (&batch.workers[i].lock);
+    }
+
+  pthread_mutex_destroy (&batch.lock);
+  free (batch.workers);
+
+  for (i = 0; i < batch.num_files; i++)
+    free (batch.files[i]);
+  free (batch.files);
+
+  res = !batch.failed;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* In server mode requests are read from a stream and answered in order.
+ * A request consists of a header line followed by the input text:
+ *
+ *   check <bytes> [ -s ] [ -m <max-dec> ] [ -t <seconds> ]
+ *
+ * The header of the response is followed by the output of 'limboole' for
+ * this input, for instance the satisfying assignment:
+ *
+ *   <status> <bytes> <seconds>
+ *
+ * The status is one of SATISFIABLE, UNSATISFIABLE, VALID, INVALID,
+ * EXHAUSTED, QUERIES for inputs with queries, or ERROR.  On a Unix domain
+ * socket each connection is served by one worker of a pool.  Workers keep
+ * their manager and solver across requests, which are only reset.
+ */
+typedef struct Server Server;
+
+struct Server
+{
+  pthread_mutex_t lock;		/* protects the connection queue */
+  pthread_cond_t cond;		/* signals new connections */
+  int *connections;		/* queue of accepted connections */
+  int head_connections;
+  int num_connections;
+  int size_connections;
+  int check_satisfiability;	/* default options of requests */
+  int max_decisions;
+  double time_limit;
+  int conflict_limit;
+  size_t memory_limit;
+};
+
+#define MAX_REQUEST (64ul << 20)	/* maximal bytes of a request */
+#define SERVE_TIMEOUT 60	/* seconds until idle connections are closed */
+
+/*------------------------------------------------------------------------*/
+
+static void
+respond (FILE * file, const char *status, char *text, size_t bytes,
+	 double start)
+{
+  fprintf (file, "%s %lu %.2f\n",
+	   status, (unsigned long) bytes, wall_clock () - start);
+  fwrite (text, 1, bytes, file);
+  fflush (file);
+}
+
+/*------------------------------------------------------------------------*/
+/* Check the input 'text' with the limits of the request and return the
+ * status.  The output is written to the memory stream 'output'.
+ */
+static const char *
+serve_request (Mgr * mgr, char *text, FILE * output,
+	       int max_decisions, double time_limit)
+{
+  FILE *saved_out, *saved_log;
+  const char *saved_name;
+  const char *res;
+  Query *q;
+
+  saved_out = mgr->out;
+  saved_log = mgr->log;
+  saved_name = mgr->name;
+
+  reset (mgr);
+  mgr->text = text;
+  mgr->name = "<request>";
+  mgr->out = output;
+  mgr->log = output;
+
+  if (!parse (mgr))
+    res = "ERROR";
+  else
+    {
+      mgr->time_limit = time_limit;
+      if (mgr->limmat)
+	set_limits (mgr);
+      encode (mgr);
+
+      if (mgr->root)
+	res = status (mgr->check_satisfiability,
+		      solve (mgr, mgr->root, 0, max_decisions));
+      else
+	{
+	  res = "QUERIES";
+	  for (q = mgr->first_query; q; q = q->next)
+	    {
+	      fprintf (mgr->out, "%% %s\n", q->name);
+	      if (solve (mgr, q->root, 1, max_decisions) < 0)
+		res = "EXHAUSTED";
+	    }
+	}
+    }
+
+  mgr->text = 0;
+  mgr->out = saved_out;
+  mgr->log = saved_log;
+  mgr->name = saved_name;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Parse the options of a request header.  Returns zero if the header is
+ * invalid.
+ */
+static int
+parse_header (Mgr * mgr, char *header, unsigned long *bytes_ptr,
+	      int *max_decisions_ptr, double *time_limit_ptr)
+{
+  char *token, *save;
+
+  token = strtok_r (header, " \t\r\n", &save);
+  if (!token || strcmp (token, "check"))
+    return 0;
+
+  token = strtok_r (0, " \t\r\n", &save);
+  if (!token || !isdigit ((int) *token))
+    return 0;
+
+  *bytes_ptr = strtoul (token, 0, 10);
+
+  while ((token = strtok_r (0, " \t\r\n", &save)))
+    {
+      if (!strcmp (token, "-s"))
+	mgr->check_satisfiability = 1;
+      else if (!strcmp (token, "-m") &&
+	       (token = strtok_r (0, " \t\r\n", &save)))
+	*max_decisions_ptr = atoi (token);
+      else if (!strcmp (token, "-t") &&
+	       (token = strtok_r (0, " \t\r\n", &save)))
+	*time_limit_ptr = atof (token);
+      else
+	return 0;
+    }
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* Read and drop the 'bytes' bytes of a request, which is not checked.
+ * Returns zero if the input ends before.
+ */
+static int
+skip_request (FILE * file, unsigned long bytes)
+{
+  char buffer[4096];
+  size_t n;
+
+  while (bytes > 0)
+    {
+      n = (bytes < sizeof buffer) ? bytes : sizeof buffer;
+      if (fread (buffer, 1, n, file) != n)
+	return 0;
+      bytes -= n;
+    }
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* Serve all requests of one connection.  An invalid request terminates the
+ * connection after an error response.  Requests larger than 'MAX_REQUEST'
+ * or which can not be allocated are skipped and answered with an error.
+ */
+static void
+serve_connection (Server * server, Mgr * mgr, FILE * in, FILE * out)
+{
+  char *header, *text, *output;
+  size_t header_size, size;
+  unsigned long bytes;
+  double time_limit;
+  int max_decisions;
+  const char *res;
+  FILE *stream;
+  double start;
+
+  header = 0;
+  header_size = 0;
+
+  while (getline (&header, &header_size, in) > 0)
+    {
+      start = wall_clock ();
+      mgr->check_satisfiability = server->check_satisfiability;
+      max_decisions = server->max_decisions;
+      time_limit = server->time_limit;
+      mgr->conflict_limit = server->conflict_limit;
+      mgr->memory_limit = server->memory_limit;
+
+      if (!parse_header (mgr, header, &bytes,
+			 &max_decisions, &time_limit))
+	{
+	  output = "invalid request header\n";
+	  respond (out, "ERROR", output, strlen (output), start);
+	  break;
+	}
+
+      text = (bytes <= MAX_REQUEST) ? (char *) malloc (bytes + 1) : 0;
+      if (!text)
+	{
+	  output = (bytes <= MAX_REQUEST) ?
+	    "out of memory\n" : "request too large\n";
+	  respond (out, "ERROR", output, strlen (output), start);
+	  if (!skip_request (in, bytes))
+	    break;
+	  continue;
+	}
+
+      if (fread (text, 1, bytes, in) != bytes)
+	{
+	  free (text);
+	  output = "incomplete request\n";
+	  respond (out, "ERROR", output, strlen (output), start);
+	  break;
+	}
+      text[bytes] = 0;
+
+      output = 0;
+      size = 0;
+      stream = open_memstream (&output, &size);
+      res = serve_request (mgr, text, stream, max_decisions, time_limit);
+      fclose (stream);
+
+      respond (out, res, output, size, start);
+
+      free (output);
+      free (text);
+    }
+
+  free (header);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void *
+serve_worker (void *arg)
+{
+  Server *server;
+  FILE *in, *out;
+  Mgr *mgr;
+  int fd;
+
+  server = (Server *) arg;
+  mgr = init ();
+
+  for (;;)
+    {
+      pthread_mutex_lock (&server->lock);
+      while (!server->num_connections)
+	pthread_cond_wait (&server->cond, &server->lock);
+      fd = server->connections[server->head_connections++];
+      if (server->head_connections == server->size_connections)
+	server->head_connections = 0;
+      server->num_connections--;
+      pthread_mutex_unlock (&server->lock);
+
+      in = fdopen (fd, "r");
+      out = fdopen (dup (fd), "w");
+
+      if (in && out)
+	serve_connection (server, mgr, in, out);
+
+      if (in)
+	fclose (in);
+      else
+	close (fd);
+
+      if (out)
+	fclose (out);
+    }
+
+  release (mgr);
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+enqueue_connection (Server * server, int fd)
+{
+  int *connections, i, j;
+
+  pthread_mutex_lock (&server->lock);
+
+  if (server->num_connections == server->size_connections)
+    {
+      connections = (int *) malloc (2 * server->size_connections *
+				    sizeof (int));
+      for (i = 0; i < server->num_connections; i++)
+	{
+	  j = server->head_connections + i;
+	  if (j >= server->size_connections)
+	    j -= server->size_connections;
+	  connections[i] = server->connections[j];
+	}
+
+      free (server->connections);
+      server->connections = connections;
+      server->head_connections = 0;
+      server->size_connections *= 2;
+    }
+
+  i = server->head_connections + server->num_connections++;
+  if (i >= server->size_connections)
+    i -= server->size_connections;
+  server->connections[i] = fd;
+
+  pthread_cond_signal (&server->cond);
+  pthread_mutex_unlock (&server->lock);
+}
+
+/*------------------------------------------------------------------------*/
+/* Without socket requests are read from the input file of 'mgr'.  With a
+ * socket connections are accepted until an error occurs.
+ */
+static int
+serve (Mgr * mgr, const char *path, int num_workers,
+       int max_decisions, double time_limit)
+{
+  struct sockaddr_un addr;
+  struct timeval timeout;
+  pthread_t thread;
+  Server server;
+  struct stat buf;
+  int fd, conn, i;
+
+  memset (&server, 0, sizeof (server));
+  server.check_satisfiability = mgr->check_satisfiability;
+  server.max_decisions = max_decisions;
+  server.time_limit = time_limit;
+  server.conflict_limit = mgr->conflict_limit;
+  server.memory_limit = mgr->memory_limit;
+
+  if (!path)
+    {
+      serve_connection (&server, mgr, mgr->in, mgr->out);
+      return 1;
+    }
+
+  if (strlen (path) >= sizeof (addr.sun_path))
+    {
+      fprintf (mgr->log, "*** socket path '%s' too long\n", path);
+      return 0;
+    }
+
+  /* Remove a stale socket of a previous server.
+   */
+  if (!stat (path, &buf) && S_ISSOCK (buf.st_mode))
+    unlink (path);
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, path);
+
+  if ((fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+      bind (fd, (struct sockaddr *) &addr, sizeof (addr)) ||
+      listen (fd, 16))
+    {
+      fprintf (mgr->log, "*** could not listen on '%s'\n", path);
+      if (fd >= 0)
+	close (fd);
+      return 0;
+    }
+
+  /* Clients closing their connection early should not kill the server.
+   */
+  signal (SIGPIPE, SIG_IGN);
+
+  pthread_mutex_init (&server.lock, 0);
+  pthread_cond_init (&server.cond, 0);
+  server.size_connections = 16;
+  server.connections = (int *) malloc (server.size_connections *
+				       sizeof (int));
+
+  for (i = 0; i < num_workers; i++)
+    {
+      pthread_create (&thread, 0, serve_worker, &server);
+      pthread_detach (thread);
+    }
+
+  /* A worker serves one connection until it is closed, thus idle clients
+   * would block the worker forever.
+   */
+  timeout.tv_sec = SERVE_TIMEOUT;
+  timeout.tv_usec = 0;
+
+  while ((conn = accept (fd, 0, 0)) >= 0)
+    {
+      setsockopt (conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+      enqueue_connection (&server, conn);
+    }
+
+  fprintf (mgr->log, "*** could not accept connection on '%s'\n", path);
+  close (fd);
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+/* In watch mode the input file is checked again whenever it changes.  The
+ * new input is parsed into the same hash table, so unchanged subformulas
+ * are mapped to their old nodes and only new nodes are encoded.  Roots are
+ * not added as units but assumed, which retracts them for the next round
+ * and keeps all learned clauses valid.  If most of the nodes are not used
+ * anymore everything is reset.  The watch ends when the file is removed.
+ */
+#define WATCH_INTERVAL 100000	/* micro seconds between polls */
+#define WATCH_GARBAGE 4		/* reset if nodes exceed live nodes times */
+
+/*------------------------------------------------------------------------*/
+
+static int
+same_file (struct stat *a, struct stat *b)
+{
+  return a->st_ino == b->st_ino &&
+    a->st_size == b->st_size &&
+    a->st_mtim.tv_sec == b->st_mtim.tv_sec &&
+    a->st_mtim.tv_nsec == b->st_mtim.tv_nsec;
+}
+
+/*------------------------------------------------------------------------*/
+
+static unsigned
+count_live_nodes (Mgr * mgr, Node * root)
+{
+  unsigned res;
+  Query *q;
+  Node *p;
+
+  mgr->stamp++;
+
+  if (root)
+    mark_cone (mgr, root);
+
+  for (q = mgr->first_query; q; q = q->next)
+    mark_cone (mgr, q->root);
+
+  res = 0;
+  for (p = mgr->first; p; p = p->next_inserted)
+    if (p->mark == mgr->stamp)
+      res++;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+watch (Mgr * mgr, const char *path, int max_decisions)
+{
+  struct stat last, buf;
+  unsigned old_count;
+  unsigned live;
+  double start;
+  Node *root;
+  Query *q;
+  int round;
+
+  if (stat (path, &last))
+    return 0;
+
+  live = 0;
+
+  for (round = 1;; round++)
+    {
+      start = wall_clock ();
+
+      if (mgr->nodes_count > WATCH_GARBAGE * live + 1000)
+	reset (mgr);
+
+      release_defs (mgr);
+      release_queries (mgr);
+      reset_parser (mgr);
+
+      old_count = mgr->nodes_count;
+      root = 0;
+
+      if (parse (mgr))
+	{
+	  /* Otherwise 'tsetin' would add the root as unit.
+	   */
+	  root = mgr->root;
+	  mgr->root = 0;
+
+	  if (root)
+	    solve (mgr, root, 1, max_decisions);
+
+	  for (q = mgr->first_query; q; q = q->next)
+	    {
+	      fprintf (mgr->out, "%% %s\n", q->name);
+	      solve (mgr, q->root, 1, max_decisions);
+	    }
+	}
+
+      live = count_live_nodes (mgr, root);
+
+      if (mgr->verbose)
+	fprintf (mgr->log,
+		 "c round %d: %u new nodes, %u live nodes, %.2f seconds\n",
+		 round, mgr->nodes_count - old_count, live,
+		 wall_clock () - start);
+
+      fflush (mgr->out);
+      fflush (mgr->log);
+
+      do
+	{
+	  usleep (WATCH_INTERVAL);
+	  if (stat (path, &buf))
+	    return 1;
+	}
+      while (same_file (&last, &buf));
+
+      /* Wait until the file is not written anymore.
+       */
+      do
+	{
+	  last = buf;
+	  usleep (WATCH_INTERVAL);
+	  if (stat (path, &buf))
+	    return 1;
+	}
+      while (!same_file (&last, &buf));
+
+      fclose (mgr->in);
+      if (!(mgr->in = fopen (path, "r")))
+	{
+	  mgr->close_in = 0;
+	  return 1;
+	}
+    }
+}
+
+/*------------------------------------------------------------------------*/
+/* Approximate number of bytes allocated by the front end.  Since nodes are
+ * never removed during a run this is also the maximum.
+ */
+static size_t
+frontend_bytes (Mgr * mgr)
+{
+  size_t res;
+
+  res = sizeof (*mgr);
+  res += mgr->nodes_size * sizeof (Node *);
+  res += mgr->nodes_count * sizeof (Node);
+  res += mgr->defs_size * sizeof (Def *);
+  res += mgr->defs_count * sizeof (Def);
+  res += mgr->name_bytes;
+  res += mgr->buffer_size + mgr->saved_buffer_size;
+
+  if (mgr->idx2node)
+    res += (mgr->idx + 1) * sizeof (Node *);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Print the statistics of the phases as '<key> <value>' lines, preceded by
+ * 'c ' and aligned with '-v -v' and without prefix for '--stats'.
+ */
+static void
+print_stats (Mgr * mgr, int machine)
+{
+  static const char *names[IFF + 1] = {
+    "var", 0, 0, "not", "and", "or", "implies", "iff"
+  };
+  unsigned num_clauses;
+  const char *prefix;
+  const char *fmt;
+  FILE *file;
+  int t;
+
+  file = mgr->log;
+  prefix = machine ? "" : "c ";
+  fmt = machine ? "%s%s %.6f\n" : "%s%-20s %.2f\n";
+
+  fprintf (file, fmt, prefix, "time.parse", mgr->parse_time);
+  fprintf (file, fmt, prefix, "time.encode", mgr->encode_time);
+  fprintf (file, fmt, prefix, "time.add", mgr->add_time);
+  fprintf (file, fmt, prefix, "time.solve", mgr->solve_time);
+
+  fmt = machine ? "%s%s %u\n" : "%s%-20s %u\n";
+
+  fprintf (file, fmt, prefix, "nodes", mgr->nodes_count);
+  for (t = VAR; t <= IFF; t++)
+    if (names[t])
+      fprintf (file, machine ? "%snodes.%s %u\n" : "%snodes.%-14s %u\n",
+	       prefix, names[t], mgr->nodes_by_type[t]);
+
+  fprintf (file, fmt, prefix, "hash.size", mgr->nodes_size);
+  fprintf (file, fmt, prefix, "hash.rehashes", mgr->rehashes);
+  fprintf (file, machine ? "%s%s %.0f\n" : "%s%-20s %.0f\n",
+	   prefix, "hash.lookups", mgr->lookups);
+  fprintf (file, machine ? "%s%s %.3f\n" : "%s%-20s %.2f\n",
+	   prefix, "hash.load", mgr->nodes_count / (double) mgr->nodes_size);
+  fprintf (file, machine ? "%s%s %.3f\n" : "%s%-20s %.2f\n",
+	   prefix, "hash.probes",
+	   mgr->lookups ? mgr->probes / mgr->lookups : 0);
+
+  num_clauses = mgr->units;
+  for (t = VAR; t <= IFF; t++)
+    num_clauses += mgr->clauses_by_type[t];
+
+  fprintf (file, fmt, prefix, "cnf.variables", (unsigned) mgr->idx);
+  fprintf (file, fmt, prefix, "cnf.clauses", num_clauses);
+  for (t = NOT; t <= IFF; t++)
+    fprintf (file, machine ? "%scnf.clauses.%s %u\n" :
+	     "%scnf.clauses.%-8s %u\n", prefix, names[t],
+	     mgr->clauses_by_type[t]);
+  fprintf (file, fmt, prefix, "cnf.clauses.units", mgr->units);
+
+  fmt = machine ? "%s%s %lu\n" : "%s%-20s %lu\n";
+
+  fprintf (file, fmt, prefix, "bytes.frontend",
+	   (unsigned long) frontend_bytes (mgr));
+  fprintf (file, fmt, prefix, "bytes.solver",
+	   (unsigned long) (mgr->limmat ? max_bytes_Limmat (mgr->limmat) : 0));
+}
+
+/*------------------------------------------------------------------------*/
+
+#define USAGE \
+"usage: limboole [ <option> ... ]\n" \
+"\n" \
+"  -h             print this command line summary and exit\n" \
+"  --version      print the version and exit\n" \
+"  -v             increase verbosity (twice to print statistics)\n" \
+"  --stats        print statistics as '<key> <value>' lines\n" \
+"  -p             pretty print input formula only\n" \
+"  -d             dump generated CNF only\n" \
+"  -s             check satisfiability (default is to check validity)\n" \
+"  -m <max-dec>   maximal decision bound (default unbounded)\n" \
+"  -t <seconds>   wall clock time limit of the solver (default unbounded)\n" \
+"  --time <sec>   same as '-t'\n" \
+"  --conflicts <n> conflict limit of the solver (default unbounded)\n" \
+"  --memory <MB>  memory limit of the solver (default unbounded)\n" \
+"  -b <path>      check all files listed in <path> or in directory <path>\n" \
+"  -j <workers>   number of worker threads in batch and socket mode (default 1)\n" \
+"  --serve        answer requests read from <in-file> or <stdin>\n" \
+"  --socket <path> answer requests on Unix domain socket <path>, where each\n" \
+"                 worker serves one connection at a time and closes it\n" \
+"                 after 60 seconds without input\n" \
+"  -w             check <in-file> again whenever it changes\n" \
+"  -a <scenarios> check <in-file> under each scenario in <scenarios>\n" \
+"  -c <cache>     reuse and remember results in cache file <cache>\n" \
+"  -o <out-file>  set output file (default <stdout>)\n" \
+"  -l <log-file>  set log file (default <stderr>)\n" \
+"  <in-file>      input file (default <stdin>)\n"
+
+/*------------------------------------------------------------------------*/
+
+int
+limboole (int argc, char **argv)
+{
+  const char *batch_path, *socket_path, *cache_path, *scenario_path;
+  double time_limit, memory;
+  int server;
+  int watching;
+  int report;
+  int stats;
+  int num_workers;
+  int max_decisions;
+  int pretty_print;
+  FILE *file;
+  int error;
+  Query *q;
+  Mgr *mgr;
+  int done;
+  int i;
+
+  done = 0;
+  error = 0;
+  pretty_print = 0;
+  max_decisions = -1;
+  time_limit = -1;
+  batch_path = 0;
+  socket_path = 0;
+  cache_path = 0;
+  scenario_path = 0;
+  server = 0;
+  watching = 0;
+  report = 0;
+  stats = 0;
+  num_workers = 1;
+
+  mgr = init ();
+
+  for (i = 1; !done && !error && i < argc; i++)
+    {
+      if (!strcmp (argv[i], "-h"))
+	{
+	  fprintf (mgr->out, USAGE);
+	  done = 1;
+	}
+      else if (!strcmp (argv[i], "--version"))
+	{
+	  fprintf (mgr->out, "%s\n", VERSION);
+	  done = 1;
+	}
+      else if (!strcmp (argv[i], "-v"))
+	{
+	  mgr->verbose += 1;
+	}
+      else if (!strcmp (argv[i], "--stats"))
+	{
+	  stats = 1;
+	}
+      else if (!strcmp (argv[i], "-p"))
+	{
+	  pretty_print = 1;
+	}
+      else if (!strcmp (argv[i], "-d"))
+	{
+	  mgr->dump = 1;
+	}
+      else if (!strcmp (argv[i], "-s"))
+	{
+	  mgr->check_satisfiability = 1;
+	}
+      else if (!strcmp (argv[i], "-m"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log, "*** argument to '-m' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else
+	    max_decisions = atoi (argv[++i]);
+	}
+      else if (!strcmp (argv[i], "-t") || !strcmp (argv[i], "--time"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log,
+		       "*** argument to '%s' missing (try '-h')\n", argv[i]);
+	      error = 1;
+	    }
+	  else
+	    time_limit = atof (argv[++i]);
+	}
+      else if (!strcmp (argv[i], "--conflicts"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log,
+		       "*** argument to '--conflicts' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else if ((mgr->conflict_limit = atoi (argv[++i])) <= 0)
+	    {
+	      fprintf (mgr->log, "*** invalid conflict limit '%s'\n", argv[i]);
+	      error = 1;
+	    }
+	}
+      else if (!strcmp (argv[i], "--memory"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log,
+		       "*** argument to '--memory' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else if ((memory = atof (argv[++i])) <= 0)
+	    {
+	      fprintf (mgr->log, "*** invalid memory limit '%s'\n", argv[i]);
+	      error = 1;
+	    }
+	  else
+	    mgr->memory_limit = (size_t) (memory * (1 << 20));
+	}
+      else if (!strcmp (argv[i], "-b"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log, "*** argument to '-b' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else
+	    batch_path = argv[++i];
+	}
+      else if (!strcmp (argv[i], "-j"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log, "*** argument to '-j' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else if ((num_workers = atoi (argv[++i])) <= 0)
+	    {
+	      fprintf (mgr->log,
+		       "*** invalid number of workers '%s'\n", argv[i]);
+	      error = 1;
+	    }
+	}
+      else if (!strcmp (argv[i], "-w"))
+	{
+	  watching = 1;
+	}
+      else if (!strcmp (argv[i], "-a"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log, "*** argument to '-a' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else
+	    scenario_path = argv[++i];
+	}
+      else if (!strcmp (argv[i], "-c"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log, "*** argument to '-c' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else
+	    cache_path = argv[++i];
+	}
+      else if (!strcmp (argv[i], "--serve"))
+	{
+	  server = 1;
+	}
+      else if (!strcmp (argv[i], "--socket"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log,
+		       "*** argument to '--socket' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else
+	    {
+	      socket_path = argv[++i];
+	      server = 1;
+	    }
+	}
+      else if (!strcmp (argv[i], "-o"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log, "*** argument to '-o' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else if (!(file = fopen (argv[++i], "w")))
+	    {
+	      fprintf (mgr->log, "*** could not write '%s'\n", argv[i]);
+	      error = 1;
+	    }
+	  else if (mgr->close_out)
+	    {
+	      /* We moved this down for coverage in testing purposes */
+	      fclose (file);
+	      fprintf (mgr->log, "*** '-o' specified twice (try '-h')\n");
+	      error = 1;
+	    }
+	  else
+	    {
+	      mgr->out = file;
+	      mgr->close_out = 1;
+	    }
+	}
+      else if (!strcmp (argv[i], "-l"))
+	{
+	  if (i == argc - 1)
+	    {
+	      fprintf (mgr->log, "*** argument to '-l' missing (try '-h')\n");
+	      error = 1;
+	    }
+	  else if (!(file = fopen (argv[++i], "a")))
+	    {
+	      fprintf (mgr->log, "*** could not append to '%s'\n", argv[i]);
+	      error = 1;
+	    }
+	  else if (mgr->close_log)
+	    {
+	      /* We moved this down for coverage in testing purposes */
+	      fclose (file);
+	      fprintf (mgr->log, "*** '-l' specified twice (try '-h')\n");
+	      error = 1;
+	    }
+	  else
+	    {
+	      mgr->log = file;
+	      mgr->close_log = 1;
+	    }
+	}
+      else if (argv[i][0] == '-')
+	{
+	  fprintf (mgr->log,
+		   "*** invalid command line option '%s' (try '-h')\n",
+		   argv[i]);
+	  error = 1;
+	}
+      else if (mgr->close_in)
+	{
+	  fprintf (mgr->log,
+		   "*** can not read more than two files (try '-h')\n");
+	  error = 1;
+	}
+      else if (!(file = fopen (argv[i], "r")))
+	{
+	  fprintf (mgr->log, "*** could not read '%s'\n", argv[i]);
+	  error = 1;
+	}
+      else
+	{
+	  mgr->in = file;
+	  mgr->name = argv[i];
+	  mgr->close_in = 1;
+	}
+    }
+
+  if (!error && !done && batch_path)
+    {
+      if (pretty_print || mgr->dump || mgr->close_in || server ||
+	  cache_path || watching || scenario_path)
+	{
+	  fprintf (mgr->log,
+		   "*** '-b' can only be combined with "
+		   "'-s', '-m', '-t' and '-j' (try '-h')\n");
+	  error = 1;
+	}
+      else
+	error = !batch (mgr, batch_path, num_workers,
+			max_decisions, time_limit);
+
+      done = 1;
+    }
+
+  if (!error && !done && server)
+    {
+      if (pretty_print || mgr->dump || cache_path || watching ||
+	  scenario_path || (socket_path && mgr->close_in))
+	{
+	  fprintf (mgr->log,
+		   "*** '--serve' can only be combined with "
+		   "'-s', '-m', '-t', '-j' and '-o' (try '-h')\n");
+	  error = 1;
+	}
+      else
+	error = !serve (mgr, socket_path, num_workers,
+			max_decisions, time_limit);
+
+      done = 1;
+    }
+
+  if (!error && !done && watching)
+    {
+      if (pretty_print || mgr->dump || cache_path || scenario_path)
+	{
+	  fprintf (mgr->log,
+		   "*** '-w' can only be combined with "
+		   "'-s', '-m', '-t', '-v', '-o' and '-l' (try '-h')\n");
+	  error = 1;
+	}
+      else if (!mgr->close_in)
+	{
+	  fprintf (mgr->log, "*** '-w' requires an input file (try '-h')\n");
+	  error = 1;
+	}
+      else
+	{
+	  mgr->time_limit = time_limit;
+	  error = !watch (mgr, mgr->name, max_decisions);
+	}
+
+      done = 1;
+    }
+
+  if (!error && !done && scenario_path && cache_path)
+    {
+      /* Cached results do not depend on scenarios.
+       */
+      fprintf (mgr->log, "*** '-a' can not be combined with '-c' (try '-h')\n");
+      error = 1;
+    }
+
+  if (!error && !done)
+    {
+      error = !parse (mgr);
+      report = 1;
+
+      if (!error)
+	{
+	  if (pretty_print)
+	    pp (mgr);
+	  else if (mgr->dump && mgr->first_query)
+	    {
+	      fprintf (mgr->log, "*** can not dump multiple queries\n");
+	      error = 1;
+	    }
+	  else if (mgr->dump)
+	    {
+	      connect_solver (mgr);
+	      tsetin (mgr);
+	    }
+	  else if (scenario_path)
+	    {
+	      mgr->time_limit = time_limit;
+	      error = !scenarios (mgr, scenario_path, max_decisions);
+	    }
+	  else
+	    {
+	      mgr->time_limit = time_limit;
+
+	      if (cache_path)
+		open_cache (mgr, cache_path);
+
+	      if (mgr->root)
+		error = (solve (mgr, mgr->root, 0, max_decisions) < 0);
+
+	      for (q = mgr->first_query; q; q = q->next)
+		{
+		  fprintf (mgr->out, "%% %s\n", q->name);
+		  if (solve (mgr, q->root, 1, max_decisions) < 0)
+		    error = 1;
+		}
+
+	      if (mgr->cache)
+		close_cache (mgr);
+	    }
+	}
+    }
+
+  /* Report what the solver achieved until a limit was exceeded.
+   */
+  if (mgr->verbose && mgr->exhausted)
+    stats_Limmat (mgr->limmat, mgr->log);
+
+  if (report && (mgr->verbose > 1 || stats))
+    print_stats (mgr, mgr->verbose <= 1);
+
+  release (mgr);
+
+  return error != 0;
+}
+
+/*------------------------------------------------------------------------*/
+/* The library interface.  See 'limboole.h' for its documentation.
+ */
+Limboole *
+new_Limboole (void)
+{
+  Mgr *res;
+
+  res = init ();
+  res->in = 0;
+  res->log = 0;
+  res->out = 0;
+  res->name = "<string>";
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+delete_Limboole (Limboole * mgr)
+{
+  release (mgr);
+}
+
+/*------------------------------------------------------------------------*/
+
+LimbooleNode *
+parse_Limboole (Limboole * mgr, const char *text)
+{
+  Node *res;
+
+  assert (text);
+
+  mgr->text = text;
+  reset_parser (mgr);
+
+  if (parse (mgr) && mgr->first_query)
+    parse_error (mgr, "queries are not supported by the library");
+
+  res = mgr->error ? 0 : mgr->root;
+  release_queries (mgr);
+  mgr->root = 0;
+  mgr->text = 0;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+const char *
+error_Limboole (Limboole * mgr)
+{
+  return mgr->error;
+}
+
+/*------------------------------------------------------------------------*/
+
+LimbooleNode *
+var_Limboole (Limboole * mgr, const char *name)
+{
+  assert (name);
+  return var (mgr, name);
+}
+
+/*------------------------------------------------------------------------*/
+
+LimbooleNode *
+not_Limboole (Limboole * mgr, LimbooleNode * child)
+{
+  assert (child);
+  return op (mgr, NOT, child, 0);
+}
+
+/*------------------------------------------------------------------------*/
+
+LimbooleNode *
+and_Limboole (Limboole * mgr, LimbooleNode * c0, LimbooleNode * c1)
+{
+  assert (c0 && c1);
+  return op (mgr, AND, c0, c1);
+}
+
+/*------------------------------------------------------------------------*/
+
+LimbooleNode *
+or_Limboole (Limboole * mgr, LimbooleNode * c0, LimbooleNode * c1)
+{
+  assert (c0 && c1);
+  return op (mgr, OR, c0, c1);
+}
+
+/*------------------------------------------------------------------------*/
+
+LimbooleNode *
+implies_Limboole (Limboole * mgr, LimbooleNode * c0, LimbooleNode * c1)
+{
+  assert (c0 && c1);
+  return op (mgr, IMPLIES, c0, c1);
+}
+
+/*------------------------------------------------------------------------*/
+
+LimbooleNode *
+iff_Limboole (Limboole * mgr, LimbooleNode * c0, LimbooleNode * c1)
+{
+  assert (c0 && c1);
+  return op (mgr, IFF, c0, c1);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+set_max_decisions_Limboole (Limboole * mgr, int max_decisions)
+{
+  mgr->max_decisions = max_decisions;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+set_time_limit_Limboole (Limboole * mgr, double seconds)
+{
+  mgr->time_limit = seconds;
+}
+
+/*------------------------------------------------------------------------*/
+/* Save the assignment of the solver, which becomes invalid as soon as the
+ * solver is used again, and the variables in the cone of 'root'.
+ */
+static void
+save_model (Mgr * mgr, Node * root)
+{
+  const int *assignment, *p;
+  Node *n;
+  int idx;
+
+  assignment = assignment_Limmat (mgr->limmat);
+  assert (assignment);
+
+  mgr->num_values = mgr->idx + 1;
+  mgr->values = (signed char *) realloc (mgr->values, mgr->num_values);
+  memset (mgr->values, -1, mgr->num_values);
+
+  for (p = assignment; *p; p++)
+    {
+      idx = (*p < 0) ? -*p : *p;
+      assert (idx < mgr->num_values);
+      mgr->values[idx] = (*p > 0);
+    }
+
+  mgr->stamp++;
+  mark_cone (mgr, root);
+
+  for (idx = 1; idx <= mgr->idx; idx++)
+    {
+      n = mgr->idx2node[idx];
+      if (n->type != VAR || n->mark != mgr->stamp)
+	continue;
+
+      if (mgr->model_capacity <= mgr->model_size)
+	{
+	  mgr->model_capacity = mgr->model_capacity ?
+	    2 * mgr->model_capacity : 16;
+	  mgr->model = (Node **)
+	    realloc (mgr->model, mgr->model_capacity * sizeof (Node *));
+	}
+
+      mgr->model[mgr->model_size++] = n;
+    }
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+check_Limboole (Mgr * mgr, Node * root, int check_satisfiability)
+{
+  int res;
+
+  assert (root);
+
+  if (!mgr->limmat)
+    connect_solver (mgr);
+
+  set_time_limit_Limmat (mgr->limmat, mgr->time_limit);
+  tsetin (mgr);
+
+  mgr->check_satisfiability = check_satisfiability;
+  res = check (mgr, root, 1, mgr->max_decisions);
+
+  mgr->model_size = 0;
+  mgr->num_values = 0;
+
+  if (res == 1)
+    save_model (mgr, root);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+sat_Limboole (Limboole * mgr, LimbooleNode * root)
+{
+  return check_Limboole (mgr, root, 1);
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+valid_Limboole (Limboole * mgr, LimbooleNode * root)
+{
+  int res;
+
+  res = check_Limboole (mgr, root, 0);
+  if (res >= 0)
+    res = !res;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+model_size_Limboole (Limboole * mgr)
+{
+  return mgr->model_size;
+}
+
+/*------------------------------------------------------------------------*/
+
+const char *
+model_name_Limboole (Limboole * mgr, int i)
+{
+  assert (0 <= i && i < mgr->model_size);
+  return mgr->model[i]->data.as_name;
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+model_value_Limboole (Limboole * mgr, int i)
+{
+  assert (0 <= i && i < mgr->model_size);
+  return mgr->values[mgr->model[i]->idx];
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+value_Limboole (Limboole * mgr, LimbooleNode * node)
+{
+  if (node->idx <= 0 || node->idx >= mgr->num_values)
+    return -1;
+
+  return mgr->values[node->idx];
 }
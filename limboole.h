@@ -0,0 +1,77 @@
+#ifndef _limboole_h_INCLUDED
+#define _limboole_h_INCLUDED
+
+/*------------------------------------------------------------------------*/
+/* The command line interface.  The arguments are the same as for the
+ * 'limboole' program.  The result is the exit code of the program.
+ */
+int limboole (int argc, char **argv);
+
+/*------------------------------------------------------------------------*/
+/* The library interface works on handles.  Each handle has its own nodes,
+ * definitions and SAT solver and is not shared with other handles, so
+ * separate handles can be used from different threads in parallel.  A
+ * single handle must not be accessed concurrently.
+ */
+typedef struct Limboole Limboole;
+typedef struct LimbooleNode LimbooleNode;
+
+/*------------------------------------------------------------------------*/
+/* Constructor and destructor.  All nodes of a handle are owned by the
+ * handle and become invalid after 'delete_Limboole'.
+ */
+Limboole *new_Limboole (void);
+void delete_Limboole (Limboole *);
+
+/*------------------------------------------------------------------------*/
+/* Parse a zero terminated string in the input language of 'limboole'.  It
+ * may contain definitions, which are kept in the handle and can be used by
+ * later calls, followed by a formula, but no queries.  The result is the
+ * node of the formula.  On a parse error zero is returned and the error
+ * message can be extracted with 'error_Limboole'.
+ */
+LimbooleNode *parse_Limboole (Limboole *, const char *text);
+const char *error_Limboole (Limboole *);
+
+/*------------------------------------------------------------------------*/
+/* Build formulas directly.  Nodes are hash-consed, so building the same
+ * formula twice returns the same node.
+ */
+LimbooleNode *var_Limboole (Limboole *, const char *name);
+LimbooleNode *not_Limboole (Limboole *, LimbooleNode *);
+LimbooleNode *and_Limboole (Limboole *, LimbooleNode *, LimbooleNode *);
+LimbooleNode *or_Limboole (Limboole *, LimbooleNode *, LimbooleNode *);
+LimbooleNode *implies_Limboole (Limboole *, LimbooleNode *, LimbooleNode *);
+LimbooleNode *iff_Limboole (Limboole *, LimbooleNode *, LimbooleNode *);
+
+/*------------------------------------------------------------------------*/
+/* Limits for each call to 'sat_Limboole' and 'valid_Limboole'.  A negative
+ * value, which is the default, means unbounded.
+ */
+void set_max_decisions_Limboole (Limboole *, int max_decisions);
+void set_time_limit_Limboole (Limboole *, double seconds);
+
+/*------------------------------------------------------------------------*/
+/* Check satisfiability respectively validity of a formula.  The result is
+ * '1' if the formula is satisfiable respectively valid, '0' if it is not,
+ * and negative if a limit was exceeded.  Formulas checked with the same
+ * handle are encoded incrementally into the same solver.  A satisfying
+ * assignment respectively a falsifying assignment can be extracted after
+ * 'sat_Limboole' returned '1' respectively 'valid_Limboole' returned '0'.
+ */
+int sat_Limboole (Limboole *, LimbooleNode *);
+int valid_Limboole (Limboole *, LimbooleNode *);
+
+/*------------------------------------------------------------------------*/
+/* Iterate the assignment of the variables of the last checked formula.
+ * The variables are numbered from '0' to 'model_size_Limboole () - 1'.
+ * With 'value_Limboole' the value of an arbitrary node of the last checked
+ * formula can be obtained.  It returns '-1' if the value is unknown.
+ */
+int model_size_Limboole (Limboole *);
+const char *model_name_Limboole (Limboole *, int i);
+int model_value_Limboole (Limboole *, int i);
+int value_Limboole (Limboole *, LimbooleNode *);
+
+/*------------------------------------------------------------------------*/
+#endif
@@ -0,0 +1,524 @@
+/*------------------------------------------------------------------------*/
+/* Benchmark harness for the solver.  It needs the internal statistics of
+ * the solver, so the library source is included here.  Each instance is
+ * solved several times from scratch after some warm-up runs.  The median
+ * of the solving times is reported together with the search statistics of
+ * the last run, which do not depend on the run, since the solver is
+ * deterministic.  The results can be compared to a baseline, which is the
+ * CSV output of an earlier run.
+ */
+#include "limmat.c"
+
+/*------------------------------------------------------------------------*/
+
+typedef struct Measurement Measurement;
+typedef struct Baseline Baseline;
+
+struct Measurement
+{
+  const char *path;
+  char *instance;
+  int result;
+  int runs;
+  double seconds;			/* median */
+  double min_seconds, max_seconds;
+  double decisions, conflicts, propagations, visits;
+  double learned_clauses, learned_literals;
+  double restarts;
+  size_t bytes, max_bytes;
+};
+
+struct Baseline
+{
+  int count, size;
+  char **instances;
+  double *seconds;
+};
+
+/*------------------------------------------------------------------------*/
+
+static const char *default_instances[] = {
+  "examples/add16.in",
+  "examples/add32.in",
+  "examples/add64.in",
+  "examples/prime961.in",
+  "examples/prime1369.in",
+  "examples/prime1681.in",
+  "examples/prime1849.in",
+  "examples/prime2209.in",
+  0
+};
+
+/*------------------------------------------------------------------------*/
+/* Instances are named by their file name without directory and '.in'.
+ */
+static char *
+instance_name (const char *path)
+{
+  const char *start;
+  size_t len;
+  char *res;
+
+  start = strrchr (path, '/');
+  start = start ? start + 1 : path;
+  len = strlen (start);
+  if (len > 3 && !strcmp (start + len - 3, ".in"))
+    len -= 3;
+
+  res = (char *) malloc (len + 1);
+  memcpy (res, start, len);
+  res[len] = 0;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+cmp_double (const void *p, const void *q)
+{
+  double a, b;
+
+  a = *(const double *) p;
+  b = *(const double *) q;
+
+  return (a < b) ? -1 : (a > b);
+}
+
+/*------------------------------------------------------------------------*/
+/* Solve the instance in 'path' once.  Only the time spent in 'sat_Limmat'
+ * is measured.  The statistics are saved if 'measurement' is non zero.
+ * Returns the time or a negative number on error.
+ */
+static double
+run (const char *path, Measurement * measurement)
+{
+  Statistics *stats;
+  Limmat *limmat;
+  double start, res;
+  FILE *file;
+  int result;
+
+  if (!(file = fopen (path, "r")))
+    {
+      fprintf (stderr, "*** bench: can not read '%s'\n", path);
+      return -1;
+    }
+
+  limmat = new_Limmat (0);
+  if (!read_Limmat (limmat, file, path))
+    {
+      fprintf (stderr, "*** bench: %s\n", error_Limmat (limmat));
+      delete_Limmat (limmat);
+      fclose (file);
+      return -1;
+    }
+
+  fclose (file);
+
+  start = get_time ();
+  result = sat_Limmat (limmat, -1);
+  res = stop_timer (start);
+
+  if (measurement)
+    {
+      stats = limmat->stats;
+      measurement->result = result;
+      measurement->decisions = limmat->num_decisions;
+      measurement->conflicts = limmat->num_conflicts;
+      measurement->restarts = limmat->restart.finished;
+      measurement->propagations = stats ? stats->propagations : 0;
+      measurement->visits = stats ? stats->visits : 0;
+      measurement->learned_clauses = stats ? stats->learned_clauses : 0;
+      measurement->learned_literals = stats ? stats->learned_literals : 0;
+      measurement->bytes = bytes_Limmat (limmat);
+      measurement->max_bytes = max_bytes_Limmat (limmat);
+    }
+
+  delete_Limmat (limmat);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+measure (Measurement * m, int warmup, int runs)
+{
+  double *times;
+  int i;
+
+  for (i = 0; i < warmup; i++)
+    if (run (m->path, 0) < 0)
+      return 0;
+
+  times = (double *) malloc (runs * sizeof (double));
+
+  for (i = 0; i < runs; i++)
+    if ((times[i] = run (m->path, m)) < 0)
+      {
+	free (times);
+	return 0;
+      }
+
+  qsort (times, runs, sizeof (double), cmp_double);
+
+  m->runs = runs;
+  m->min_seconds = times[0];
+  m->max_seconds = times[runs - 1];
+  m->seconds = (runs & 1) ?
+    times[runs / 2] : (times[runs / 2 - 1] + times[runs / 2]) / 2;
+
+  free (times);
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+static double
+ratio (double a, double b)
+{
+  return b > 0 ? a / b : 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+#define CSV_HEADER \
+"instance,result,runs,seconds,min_seconds,max_seconds," \
+"decisions,conflicts,propagations,visits,restarts," \
+"decisions_per_sec,conflicts_per_sec,propagations_per_sec," \
+"visits_per_propagation,learned_clauses,avg_learned_length," \
+"bytes,max_bytes\n"
+
+static void
+print_csv (FILE * file, Measurement * m)
+{
+  fprintf (file,
+	   "%s,%d,%d,%.3f,%.3f,%.3f,"
+	   "%.0f,%.0f,%.0f,%.0f,%.0f,"
+	   "%.0f,%.0f,%.0f,"
+	   "%.2f,%.0f,%.2f,"
+	   "%lu,%lu\n",
+	   m->instance, m->result, m->runs,
+	   m->seconds, m->min_seconds, m->max_seconds,
+	   m->decisions, m->conflicts, m->propagations, m->visits,
+	   m->restarts,
+	   ratio (m->decisions, m->seconds),
+	   ratio (m->conflicts, m->seconds),
+	   ratio (m->propagations, m->seconds),
+	   ratio (m->visits, m->propagations),
+	   m->learned_clauses,
+	   ratio (m->learned_literals, m->learned_clauses),
+	   (unsigned long) m->bytes, (unsigned long) m->max_bytes);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+print_json (FILE * file, Measurement * m, int first)
+{
+  fprintf (file, "%s  {\n", first ? "" : ",\n");
+  fprintf (file, "    \"instance\": \"%s\",\n", m->instance);
+  fprintf (file, "    \"result\": %d,\n", m->result);
+  fprintf (file, "    \"runs\": %d,\n", m->runs);
+  fprintf (file, "    \"seconds\": %.3f,\n", m->seconds);
+  fprintf (file, "    \"min_seconds\": %.3f,\n", m->min_seconds);
+  fprintf (file, "    \"max_seconds\": %.3f,\n", m->max_seconds);
+  fprintf (file, "    \"decisions\": %.0f,\n", m->decisions);
+  fprintf (file, "    \"conflicts\": %.0f,\n", m->conflicts);
+  fprintf (file, "    \"propagations\": %.0f,\n", m->propagations);
+  fprintf (file, "    \"visits\": %.0f,\n", m->visits);
+  fprintf (file, "    \"restarts\": %.0f,\n", m->restarts);
+  fprintf (file, "    \"decisions_per_sec\": %.0f,\n",
+	   ratio (m->decisions, m->seconds));
+  fprintf (file, "    \"conflicts_per_sec\": %.0f,\n",
+	   ratio (m->conflicts, m->seconds));
+  fprintf (file, "    \"propagations_per_sec\": %.0f,\n",
+	   ratio (m->propagations, m->seconds));
+  fprintf (file, "    \"visits_per_propagation\": %.2f,\n",
+	   ratio (m->visits, m->propagations));
+  fprintf (file, "    \"learned_clauses\": %.0f,\n", m->learned_clauses);
+  fprintf (file, "    \"avg_learned_length\": %.2f,\n",
+	   ratio (m->learned_literals, m->learned_clauses));
+  fprintf (file, "    \"bytes\": %lu,\n", (unsigned long) m->bytes);
+  fprintf (file, "    \"max_bytes\": %lu\n", (unsigned long) m->max_bytes);
+  fprintf (file, "  }");
+}
+
+/*------------------------------------------------------------------------*/
+/* Read the columns 'instance' and 'seconds' of a CSV file written by an
+ * earlier run.  Returns zero if the file can not be read.
+ */
+static int
+read_baseline (Baseline * baseline, const char *path)
+{
+  int col, instance_col, seconds_col, header;
+  char line[1024], *p, *instance;
+  double seconds;
+  FILE *file;
+
+  if (!(file = fopen (path, "r")))
+    return 0;
+
+  header = 1;
+  instance_col = seconds_col = -1;
+
+  while (fgets (line, sizeof (line), file))
+    {
+      instance = 0;
+      seconds = -1;
+
+      for (col = 0, p = strtok (line, ",\n"); p; col++, p = strtok (0, ",\n"))
+	{
+	  if (header)
+	    {
+	      if (!strcmp (p, "instance"))
+		instance_col = col;
+	      else if (!strcmp (p, "seconds"))
+		seconds_col = col;
+	    }
+	  else if (col == instance_col)
+	    instance = p;
+	  else if (col == seconds_col)
+	    seconds = atof (p);
+	}
+
+      if (header)
+	{
+	  header = 0;
+	  if (instance_col < 0 || seconds_col < 0)
+	    break;
+	}
+      else if (instance && seconds >= 0)
+	{
+	  if (baseline->count == baseline->size)
+	    {
+	      baseline->size = baseline->size ? 2 * baseline->size : 16;
+	      baseline->instances = (char **)
+		realloc (baseline->instances,
+			 baseline->size * sizeof (char *));
+	      baseline->seconds = (double *)
+		realloc (baseline->seconds, baseline->size * sizeof (double));
+	    }
+
+	  baseline->instances[baseline->count] = strdup (instance);
+	  baseline->seconds[baseline->count] = seconds;
+	  baseline->count++;
+	}
+    }
+
+  fclose (file);
+
+  return instance_col >= 0 && seconds_col >= 0;
+}
+
+/*------------------------------------------------------------------------*/
+/* Compare one measurement to the baseline.  Differences below the timer
+ * resolution are not considered.  Returns non zero for a regression.
+ */
+#define MIN_DIFFERENCE 0.01
+
+static int
+compare (Baseline * baseline, Measurement * m, double threshold)
+{
+  double base, percent;
+  const char *verdict;
+  int i;
+
+  for (i = 0; i < baseline->count; i++)
+    if (!strcmp (baseline->instances[i], m->instance))
+      break;
+
+  if (i == baseline->count)
+    {
+      fprintf (stderr, "%-16s %8.3f %8s   not in baseline\n",
+	       m->instance, m->seconds, "");
+      return 0;
+    }
+
+  base = baseline->seconds[i];
+  percent = base > 0 ? 100 * (m->seconds - base) / base : 0;
+
+  if (m->seconds - base > MIN_DIFFERENCE && percent > threshold)
+    verdict = "REGRESSION";
+  else if (base - m->seconds > MIN_DIFFERENCE && -percent > threshold)
+    verdict = "improvement";
+  else
+    verdict = "ok";
+
+  fprintf (stderr, "%-16s %8.3f %8.3f %+7.1f%% %s\n",
+	   m->instance, m->seconds, base, percent, verdict);
+
+  return verdict[0] == 'R';
+}
+
+/*------------------------------------------------------------------------*/
+
+#define USAGE \
+"usage: bench [ <option> ... ] [ <file> ... ]\n" \
+"\n" \
+"  -h               print this command line option summary\n" \
+"  -r <runs>        number of measured runs per instance (default 5)\n" \
+"  -w <runs>        number of warm-up runs per instance (default 1)\n" \
+"  -j               write JSON instead of CSV\n" \
+"  -o <file>        write results to <file> instead of <stdout>\n" \
+"  -b <baseline>    compare to the CSV output of an earlier run\n" \
+"  -t <percent>     noise threshold for the comparison (default 10)\n" \
+"\n" \
+"Without files a default set of the examples is used.  The exit code is\n" \
+"non zero if the median time of an instance regressed by more than the\n" \
+"threshold compared to the baseline.\n"
+
+/*------------------------------------------------------------------------*/
+
+int
+main (int argc, char **argv)
+{
+  int i, runs, warmup, json, count, regressions;
+  const char *baseline_path, *output_path;
+  Measurement *measurements, *m;
+  const char **paths;
+  Baseline baseline;
+  double threshold;
+  FILE *output;
+
+  runs = 5;
+  warmup = 1;
+  json = 0;
+  threshold = 10;
+  baseline_path = 0;
+  output_path = 0;
+
+  count = sizeof (default_instances) / sizeof (default_instances[0]);
+  if (count < argc)
+    count = argc;
+
+  paths = (const char **) malloc (count * sizeof (const char *));
+  count = 0;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (!strcmp (argv[i], "-h"))
+	{
+	  printf (USAGE);
+	  exit (0);
+	}
+      else if (!strcmp (argv[i], "-j"))
+	{
+	  json = 1;
+	}
+      else if (!strcmp (argv[i], "-r") || !strcmp (argv[i], "-w") ||
+	       !strcmp (argv[i], "-o") || !strcmp (argv[i], "-b") ||
+	       !strcmp (argv[i], "-t"))
+	{
+	  if (i + 1 == argc)
+	    {
+	      fprintf (stderr,
+		       "*** bench: argument to '%s' missing (try '-h')\n",
+		       argv[i]);
+	      exit (1);
+	    }
+
+	  if (argv[i][1] == 'r')
+	    runs = atoi (argv[++i]);
+	  else if (argv[i][1] == 'w')
+	    warmup = atoi (argv[++i]);
+	  else if (argv[i][1] == 'o')
+	    output_path = argv[++i];
+	  else if (argv[i][1] == 'b')
+	    baseline_path = argv[++i];
+	  else
+	    threshold = atof (argv[++i]);
+
+	  if (runs <= 0 || warmup < 0 || threshold < 0)
+	    {
+	      fprintf (stderr,
+		       "*** bench: invalid argument '%s' to '%s'\n",
+		       argv[i], argv[i - 1]);
+	      exit (1);
+	    }
+	}
+      else if (argv[i][0] == '-')
+	{
+	  fprintf (stderr,
+		   "*** bench: unknown command line option '%s' (try '-h')\n",
+		   argv[i]);
+	  exit (1);
+	}
+      else
+	paths[count++] = argv[i];
+    }
+
+  if (!count)
+    while (default_instances[count])
+      {
+	paths[count] = default_instances[count];
+	count++;
+      }
+
+  baseline.count = baseline.size = 0;
+  baseline.instances = 0;
+  baseline.seconds = 0;
+
+  if (baseline_path && !read_baseline (&baseline, baseline_path))
+    {
+      fprintf (stderr, "*** bench: can not read baseline '%s'\n",
+	       baseline_path);
+      exit (1);
+    }
+
+  if (!output_path)
+    output = stdout;
+  else if (!(output = fopen (output_path, "w")))
+    {
+      fprintf (stderr, "*** bench: can not write '%s'\n", output_path);
+      exit (1);
+    }
+
+  measurements = (Measurement *) calloc (count, sizeof (Measurement));
+  regressions = 0;
+
+  fputs (json ? "[\n" : CSV_HEADER, output);
+
+  for (i = 0; i < count; i++)
+    {
+      m = measurements + i;
+      m->path = paths[i];
+      m->instance = instance_name (paths[i]);
+
+      if (!measure (m, warmup, runs))
+	exit (1);
+
+      if (json)
+	print_json (output, m, !i);
+      else
+	print_csv (output, m);
+
+      fflush (output);
+
+      if (baseline_path)
+	regressions += compare (&baseline, m, threshold);
+    }
+
+  if (json)
+    fputs ("\n]\n", output);
+
+  if (output_path)
+    fclose (output);
+
+  if (baseline_path)
+    fprintf (stderr, "%d regressions (threshold %.1f%%)\n",
+	     regressions, threshold);
+
+  for (i = 0; i < count; i++)
+    free (measurements[i].instance);
+  free (measurements);
+  for (i = 0; i < baseline.count; i++)
+    free (baseline.instances[i]);
+  free (baseline.instances);
+  free (baseline.seconds);
+  free (paths);
+
+  return regressions != 0;
+}
@@ -56,12 +56,19 @@ id_Limmat (void)
 #include "config.h"
 
 /*------------------------------------------------------------------------*/
+/* 'RUSAGE_THREAD' is a GNU extension and only declared by the system
+ * headers if '_GNU_SOURCE' is defined before the first of them.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <unistd.h>
@@ -115,6 +122,8 @@ version_Limmat (void)
 #define LOG_LEARNED
 #define LOG_PROPS
 #define LOG_PUSH
+#define LOG_REDUCE
+#define LOG_REPHASE
 #define LOG_RESCORE
 #define LOG_RESTART
 #define LOG_UIP
@@ -127,6 +136,8 @@ version_Limmat (void)
     defined(LOG_CONFLICT) || \
     defined(LOG_DECISION) || \
     defined(LOG_LEARNED) || \
+    defined(LOG_REDUCE) || \
+    defined(LOG_REPHASE) || \
     defined(LOG_RESCORE) || \
     defined(LOG_RESTART) || \
     defined(LOG_UIP) || \
@@ -146,6 +157,17 @@ version_Limmat (void)
 #define RESCORE 256		/* number of decisions before rescore */
 #define RESCOREFACTOR ((double)0.5) /* score factor multiplied in rescore */
 #define RESTART 10000		/* number of decisions before restart */
+#define RESTARTPOLICY 0		/* geometric (0), luby (1) or glucose (2) */
+#define LUBY 100		/* number of conflicts of one luby unit */
+#define GLUCOSEMARGIN ((double)1.25) /* restart if recent glue is larger */
+#define GLUCOSEBLOCK ((double)1.4) /* block restart if trail is larger */
+#define REDUCE 2000		/* number of conflicts before first reduction */
+#define REDUCEINC 300		/* increment of the reduction interval */
+#define REDUCEGLUE 2		/* learned clauses with this glue are kept */
+#define PHASE 1			/* decide saved phases of variables */
+#define REPHASE 1000		/* number of conflicts before first rephase */
+#define REUSE 1			/* reuse the trail on restarts */
+#define MINIMIZE 1		/* minimize learned clauses */
 #define STATISTICS 1		/* enable statistics */
 
 /*------------------------------------------------------------------------*/
@@ -200,11 +222,30 @@ version_Limmat (void)
 #endif
 #endif
 /*------------------------------------------------------------------------*/
+/* With 'TRAIL_PROPAGATION', which is set by './configure --trail', an
+ * assignment is made as soon as it is scheduled and the trail itself is
+ * used as propagation queue.  The cyclic assignment queue is not used.
+ * Since assignments are made immediately, reasons can not be shortened
+ * and a variable can not be scheduled with both signs.
+ */
+#ifdef TRAIL_PROPAGATION
+#undef SHORTEN_REASONS
+#undef EARLY_CONFLICT_DETECTION
+#endif
+/*------------------------------------------------------------------------*/
 
 #define VARIABLE_ALIGNMENT sizeof(void*)
+#define CLAUSE_ALIGNMENT sizeof(int)
 #define ALL_BUT_SIGN_BITS 0
 #define SIGN_BIT 1
 
+/* Kinds of watches stored in the two lowest bits of the blocking literal.
+ */
+#define LONG_WATCH 0
+#define BINARY_WATCH 1
+#define TERNARY_WATCH 2
+#define WATCH_KIND_BITS 2
+
 typedef struct Clause *Occurence;
 
 /*------------------------------------------------------------------------*/
@@ -337,9 +378,8 @@ struct Variable
   Stack watched[2];		/* watched occurences of this variable */
   int ref[2];			/* number of occurrences */
 
-  int saved[2];			/* old score after last rescore */
-  int score[2];			/* current score */
-  int pos[2];			/* position in order */
+  double score[2];		/* current score */
+  int pos[2];			/* position in order or -1 */
 
   int id;			/* the external integer id of a variable */
 
@@ -353,6 +393,17 @@ struct Variable
    */
   unsigned sign_in_clause:1;
 
+  /* The 'phase' is the sign of the last assignment of the variable and is
+   * only valid if 'phased' is set.  Similarly 'best' is the sign of the
+   * variable on the largest trail since the last rephase, if 'bested' is
+   * set.  See 'rephase' for more details.
+   */
+  unsigned phased:1;
+  unsigned phase:1;
+  unsigned bested:1;
+  unsigned best:1;
+
+#ifndef TRAIL_PROPAGATION
   /* If a variable is scheduled to be assigned, the position of the
    * scheduled assignment in the assignment queue is stored with the
    * variable.  This allows early detection and generation of conflicts, in
@@ -361,19 +412,25 @@ struct Variable
    */
   unsigned sign_on_queue:1;
   int pos_on_queue;
+#endif
 };
 
 /*------------------------------------------------------------------------*/
-
+/* Clauses are allocated in the clause arena.  The literals of a clause
+ * follow immediately after its header, see 'clause2literals'.
+ */
 struct Clause
 {
   unsigned learned:1;		/* external or learned clause */
-  int size:sizeof (unsigned) * 8 - 3;	/* number of literals */
+  unsigned locked:1;		/* reason of an assignment during 'reduce' */
+  unsigned garbage:1;		/* removed in the current 'reduce' */
+  int size:sizeof (unsigned) * 8 - 5;	/* number of literals */
 #ifdef OPTIMIZE_DIRECTION
   int direction:2;
 #endif
-  int literals_idx;		/* points into literal stack */
   int id;
+  int glue;			/* decision levels when learned */
+  int activity;			/* uses in conflict analysis */
   int watched[2];		/* watched literals */
 };
 
@@ -399,6 +456,7 @@ struct Frame
   Variable *decision;		/* the decisoin assignment made */
   int decision_level;
   int trail_level;		/* the old level of the trail */
+  int stamp;			/* used for computing the glue */
 };
 
 /*------------------------------------------------------------------------*/
@@ -413,6 +471,13 @@ struct Counter
   double factor, finished;
 };
 
+/*------------------------------------------------------------------------*/
+/* Kinds of rephasing, see 'rephase'.
+ */
+#define ORIGINAL_PHASES 0
+#define INVERTED_PHASES 1
+#define BEST_PHASES 2
+
 /*------------------------------------------------------------------------*/
 
 struct Statistics
@@ -421,7 +486,12 @@ struct Statistics
   double swapped, compared, searched;
   double learned_clauses, removed_clauses;
   double learned_literals, removed_literals;
-  double rescored_variables, sum_assigned_in_decision, sum_score_in_decision;
+  double bumped, sum_assigned_in_decision, sum_score_in_decision;
+  double reductions, collected_bytes;
+  double blocked;
+  double rephased[3];
+  double reused, blocked_restarts;
+  double minimized_literals, strengthened_literals;
   int original_clauses, max_clauses;
   int original_literals, max_literals;
 };
@@ -436,30 +506,44 @@ struct Limmat
   Frame *control;
   Stack trail;			/* assigned variables, ordered by decision level */
 
+#ifdef TRAIL_PROPAGATION
+  int propagated;		/* position of next assignment on trail */
+#else
   /* Scheduled assignments queue.
    */
   int head_assignments, tail_assignments, size_assignments;
   Assignment *assignments;
   int inconsistent;		/* position of first inconsistent assignment */
+#endif
 
   /* Variable manager.
    */
-  int max_id, num_literals, num_variables, current_max_score, max_score;
+  int max_id, num_literals, num_variables;
   double added_literals;
   Arena variables;
-  Stack order;			/* order variables for choosing decisions */
+  Stack order;			/* heap of literals for choosing decisions */
+  double current_max_score, max_score;
 
-  /* Maintain interval in which we do not have to perform sorting of
-   * variables in the 'order' and also do not have to search for new
-   * assignments.
+  /* The amount by which the score of a literal in a learned clause is
+   * increased.  It grows with every rescore, see 'rescore'.
    */
-  int last_assigned_pos;	/* position of last assigned variable */
-  int first_zero_pos;		/* position of first zero score variable */
+  double score_increment;
 
   /* Clause data base;
    */
   int contains_empty_clause;
-  Stack clauses, units, literals;
+  Stack clauses, units;
+  Arena clause_arena;		/* clauses and their literals */
+
+  /* Values of all literals indexed by literals, see 'lit2val'.
+   */
+  signed char *values;
+  int size_values;
+
+  /* Literals (as integers) assumed to be true in the next call to
+   * 'sat_Limmat'.  They are decided first in the given order.
+   */
+  Stack assumptions;
 
   /* Necessary statistics.
    */
@@ -476,6 +560,11 @@ struct Limmat
    */
   Stack clause;
 
+  /* Variables marked while minimizing the conflict clause, which have to be
+   * unmarked afterwards.  See 'minimize_conflict_clause'.
+   */
+  Stack redundant;
+
   /* A multipurpose stack used in inner functions onlys.
    */
   Stack stack;
@@ -488,10 +577,62 @@ struct Limmat
    */
   Counter report, restart, rescore;
 
+  /* Learned clauses are reduced if the number of conflicts reaches
+   * 'next_reduce'.  The interval between reductions starts with 'REDUCE'
+   * conflicts and grows by 'REDUCEINC' after each reduction.
+   */
+  double next_reduce;
+  int reduce_init, reduce_interval;
+
+  /* If 'save_phases' is set, decisions reuse the saved phases of
+   * variables.  Every 'rephase_init' times 'rephases' conflicts the saved
+   * phases are reset, see 'rephase'.  The size of the largest trail since
+   * the last rephase is 'best_assigned'.
+   */
+  int save_phases, rephase_init, rephases, best_assigned;
+  double next_rephase;
+
+  /* If 'reuse_trail' is set, restarts keep the decision levels that would
+   * be decided again, see 'restart'.
+   */
+  int reuse_trail;
+
+  /* If 'minimize' is set, learned clauses are minimized, see
+   * 'minimize_conflict_clause'.
+   */
+  int minimize;
+
+  /* With geometric restarts the 'restart' counter counts decisions.  Luby
+   * and glucose restarts are scheduled after 'next_restart' conflicts.  See
+   * 'its_time_to_restart' and 'update_averages' for more details.
+   */
+  int restart_policy, luby_unit, luby_index;
+  double next_restart, glucose_margin, glucose_block;
+  double fast_glue, slow_glue, trail_average, averaged;
+
+  /* Last stamp of a frame in computing the glue of a learned clause.
+   */
+  int stamp;
+
   /* See 'RESCOREFACTOR'.
    */
   double score_factor;
 
+  /* Wall clock time limit in seconds for one call to 'sat_Limmat', the
+   * wall clock time at the start of this call and the number of decisions
+   * until the time is checked again.
+   */
+  double time_limit;
+  double time_limit_start;
+  int time_limit_check;
+
+  /* Limit on the number of conflicts in one call to 'sat_Limmat' and the
+   * number of conflicts before this call.  Limit on allocated bytes.
+   */
+  double conflict_limit;
+  double conflicts_before;
+  size_t memory_limit;
+
   char *error;
   double time, timer;
 
@@ -519,6 +660,8 @@ struct Parser
   Limmat *limmat;
   int num_specified_clauses, num_specified_max_id;
   Stack literals;
+  Stack clauses;		/* read but not yet added clauses */
+  int num_buffered;		/* number of clauses in 'clauses' */
   FILE *file;
   int close_file;		/* do not close if 'file' was 'stdin' */
   int lineno;			/* lineno */
@@ -595,6 +738,19 @@ struct Parser
 #define forall_clauses(_limmat_,_ptr_to_clause_,_end_of_clauses_) \
   forall_Stack(&(_limmat_)->clauses,Clause*,_ptr_to_clause_,_end_of_clauses_)
 
+/*------------------------------------------------------------------------*/
+/* Traverse the watches on a watched stack.  A watch takes two entries, the
+ * signed clause followed by a blocking literal of the clause, which also
+ * encodes the kind of the watch.
+ *
+ * ATTENTION: These loops can not be nested.
+ */
+#define forall_watches(_stack_,_ptr_to_watch_,_end_of_watches_) \
+  for(_ptr_to_watch_ = (Occurence*) start_of_Stack(_stack_), \
+        _end_of_watches_ = (Occurence*) end_of_Stack(_stack_); \
+      _ptr_to_watch_ < _end_of_watches_; \
+      _ptr_to_watch_ += 2)
+
 /*------------------------------------------------------------------------*/
 /* Traverse the literals of a clause.
  *
@@ -606,13 +762,6 @@ struct Parser
       _ptol_ < _eol_; \
       _ptol_++)
 
-/*------------------------------------------------------------------------*/
-
-static int
-min (int a, int b)
-{
-  return (a < b) ? a : b;
-}
 
 /*------------------------------------------------------------------------*/
 #ifdef LIMMAT_WHITE
@@ -665,14 +814,22 @@ log2ceil (int n)
 #endif /* LIMMAT_WHITE */
 /*------------------------------------------------------------------------*/
 /* Get the number of seconds spent in this process including system time.
+ * If supported only the time of the calling thread is taken into account,
+ * since several solver instances may run in parallel in one process.
  */
+#ifdef RUSAGE_THREAD
+#define LIMMAT_RUSAGE_WHO RUSAGE_THREAD
+#else
+#define LIMMAT_RUSAGE_WHO RUSAGE_SELF
+#endif
+
 static double
 get_time (void)
 {
   struct rusage u;
   double res;
 
-  if (getrusage (RUSAGE_SELF, &u))
+  if (getrusage (LIMMAT_RUSAGE_WHO, &u))
     res = 0;
   else
     {
@@ -684,6 +841,25 @@ get_time (void)
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+/* Get the wall clock time in seconds, which is used for the time limit.
+ * Unlike the process time it neither depends on the load of other threads
+ * nor on time spent waiting.
+ */
+static double
+get_wall_time (void)
+{
+  struct timespec t;
+  double res;
+
+  if (clock_gettime (CLOCK_MONOTONIC, &t))
+    res = 0;
+  else
+    res = t.tv_sec + 1e-9 * t.tv_nsec;
+
+  return res;
+}
+
 /*------------------------------------------------------------------------*/
 /* To measure the time spent by a particular procedure, save the current
  * process time with 'start_timer'.  After the procedure has finished call
@@ -905,7 +1081,7 @@ resize (Limmat * limmat, void *ptr, size_t new_size, size_t old_size)
   limmat->bytes -= old_bytes;
   limmat->bytes += new_bytes;
 
-  if (old_bytes > new_bytes && limmat->max_bytes < limmat->bytes)
+  if (limmat->max_bytes < limmat->bytes)
     limmat->max_bytes = limmat->bytes;
 
   return res;
@@ -977,15 +1153,19 @@ release_Stack (Limmat * limmat, Stack * stack)
 
 /*------------------------------------------------------------------------*/
 
+/* Double the size of the stack 'doublings' times in one step.
+ */
 static void
-enlarge_Stack (Limmat * limmat, Stack * stack)
+grow_Stack (Limmat * limmat, Stack * stack, int doublings)
 {
   size_t old_bytes, new_bytes;
   int old_size, new_size;
   void *data;
 
+  assert (doublings > 0);
+
   old_size = size_Stack (stack);
-  new_size = old_size * 2;
+  new_size = old_size << doublings;
   new_bytes = new_size * sizeof (void *);
 
   if (old_size == 1)
@@ -1003,16 +1183,111 @@ enlarge_Stack (Limmat * limmat, Stack * stack)
     }
 
 #ifdef COMPACT_STACK
-  if (stack->log_size + 1 >= LOG_MAX_STACK_SIZE)
+  if (stack->log_size + doublings >= LOG_MAX_STACK_SIZE)
     abort ();
   if (stack->internal_count + 1 >= MAX_STACK_COUNT)
     abort ();
-  stack->log_size++;
+  stack->log_size += doublings;
+#else
+  stack->internal_size = new_size;
+#endif
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+enlarge_Stack (Limmat * limmat, Stack * stack)
+{
+  grow_Stack (limmat, stack, 1);
+}
+
+/*------------------------------------------------------------------------*/
+/* Make sure that 'count' elements fit into the stack without enlarging it
+ * again.
+ */
+static void
+reserve_Stack (Limmat * limmat, Stack * stack, int count)
+{
+  int size, doublings;
+
+  size = size_Stack (stack);
+
+  for (doublings = 0; size < count; doublings++)
+    size *= 2;
+
+  if (doublings)
+    grow_Stack (limmat, stack, doublings);
+}
+
+/*------------------------------------------------------------------------*/
+/* Halve the size of a stack as long as at most a quarter of it is used.
+ * The stack keeps at least two elements, such that its data remains an
+ * array.
+ */
+static void
+shrink_Stack (Limmat * limmat, Stack * stack)
+{
+  int old_size, new_size, halvings;
+  size_t old_bytes, new_bytes;
+
+  old_size = size_Stack (stack);
+  new_size = old_size;
+
+  for (halvings = 0;
+       new_size > 2 && count_Stack (stack) <= new_size / 4; halvings++)
+    new_size /= 2;
+
+  if (!halvings)
+    return;
+
+  old_bytes = old_size * sizeof (void *);
+  new_bytes = new_size * sizeof (void *);
+  stack->data.as_array = (void **)
+    resize (limmat, stack->data.as_array, new_bytes, old_bytes);
+
+#ifdef COMPACT_STACK
+  stack->log_size -= halvings;
 #else
   stack->internal_size = new_size;
 #endif
 }
 
+/*------------------------------------------------------------------------*/
+/* Make sure that the values of both literals of the variable with the
+ * identifier 'id' can be stored.  New values are unassigned.
+ */
+static void
+reserve_values (Limmat * limmat, int id)
+{
+  int old_size, new_size;
+
+  old_size = limmat->size_values;
+  if (2 * id + 1 < old_size)
+    return;
+
+  new_size = old_size ? old_size : 2;
+  while (2 * id + 1 >= new_size)
+    new_size *= 2;
+
+  if (old_size)
+    limmat->values = (signed char *)
+      resize (limmat, limmat->values, new_size, old_size);
+  else
+    limmat->values = (signed char *) new (limmat, new_size);
+
+  memset (limmat->values + old_size, 0, new_size - old_size);
+  limmat->size_values = new_size;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+release_values (Limmat * limmat)
+{
+  if (limmat->size_values)
+    delete (limmat, limmat->values, limmat->size_values);
+}
+
 /*------------------------------------------------------------------------*/
 
 inline static int
@@ -1262,6 +1537,23 @@ reset_Arena (Limmat * limmat, Arena * arena)
 
 /*------------------------------------------------------------------------*/
 
+/* Release all data of an arena after 'new_end'.
+ */
+static void
+truncate_Arena (Limmat * limmat, Arena * arena, void *new_end)
+{
+  char *p;
+
+  assert (arena->data_start <= (char *) new_end);
+  assert ((char *) new_end <= arena->data_end);
+
+  for (p = new_end; p < arena->data_end; p++)
+    *p = 0;
+  arena->data_end = new_end;
+}
+
+/*------------------------------------------------------------------------*/
+
 static void
 limmat_memcpy (char *dst, const char *src, size_t size)
 {
@@ -1413,6 +1705,67 @@ alloc_Arena (Limmat * limmat, Arena * arena, int size, size_t *delta_ptr)
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+/* Make sure that 'size' more bytes can be allocated without moving the
+ * arena.  The result is the same as for 'alloc_Arena'.
+ */
+static void
+reserve_Arena (Limmat * limmat, Arena * arena, int size, size_t *delta_ptr)
+{
+  size = align (size, arena->alignment);
+
+  if (arena->mem_start && arena->data_end + size <= arena->mem_end)
+    *delta_ptr = 0;
+  else
+    {
+      (void) alloc_Arena (limmat, arena, size, delta_ptr);
+      arena->data_end -= size;
+    }
+}
+
+/*------------------------------------------------------------------------*/
+/* Release memory of an arena, which is used by at most a quarter.  The
+ * data is copied to a new block of memory and 'delta_ptr' is set to the
+ * distance the data moved.
+ */
+static void
+shrink_Arena (Limmat * limmat, Arena * arena, size_t *delta_ptr)
+{
+  size_t old_bytes, new_bytes, data_bytes, required_bytes;
+  char *new_mem_start, *new_data_start;
+
+  *delta_ptr = 0;
+
+  if (!arena->mem_start)
+    return;
+
+  old_bytes = arena->mem_end - arena->mem_start;
+  data_bytes = arena->data_end - arena->data_start;
+  required_bytes = data_bytes + arena->alignment;
+
+  new_bytes = old_bytes;
+  while (new_bytes > 16 && 2 * required_bytes <= new_bytes / 2)
+    new_bytes /= 2;
+
+  if (new_bytes == old_bytes)
+    return;
+
+  new_mem_start = (char *) new (limmat, new_bytes);
+  memset (new_mem_start, 0, new_bytes);
+  new_data_start = align_ptr (new_mem_start, arena->alignment);
+  memcpy (new_data_start, arena->data_start, data_bytes);
+  delete (limmat, arena->mem_start, old_bytes);
+
+  *delta_ptr = new_data_start - arena->data_start;
+
+  arena->mem_start = new_mem_start;
+  arena->mem_end = new_mem_start + new_bytes;
+  arena->data_start = new_data_start;
+  arena->data_end = new_data_start + data_bytes;
+
+  invariant_Arena (limmat, arena);
+}
+
 /*------------------------------------------------------------------------*/
 
 static void *
@@ -1429,6 +1782,14 @@ end_of_Arena (Arena * arena)
   return arena->data_end;
 }
 
+/*------------------------------------------------------------------------*/
+
+static size_t
+data_bytes_Arena (Arena * arena)
+{
+  return (char *) end_of_Arena (arena) - (char *) start_of_Arena (arena);
+}
+
 /*------------------------------------------------------------------------*/
 #ifndef NDEBUG
 /*------------------------------------------------------------------------*/
@@ -1565,10 +1926,51 @@ not (void *v)
 
 /*------------------------------------------------------------------------*/
 
-static void *
-lit2var (void *v)
+/* Clause literals are integers.  The literal of the variable with the
+ * identifier 'id' is '2 * id' and its negation is '2 * id + 1'.  The
+ * following functions convert between these literals and the signed
+ * variable pointers used elsewhere.
+ */
+static Variable *
+lit2var (Limmat * limmat, int lit)
+{
+  Variable *res;
+
+  assert (lit >= 2);
+  assert (align (sizeof (Variable), VARIABLE_ALIGNMENT) == sizeof (Variable));
+
+  res = (Variable *) start_of_Arena (&limmat->variables) + (lit >> 1);
+  assert (res->id == (lit >> 1));
+  if (lit & 1)
+    res = not (res);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+var2lit (Variable * v)
+{
+  int sign;
+
+  if ((sign = is_signed (v)))
+    v = not (v);
+
+  return 2 * v->id + sign;
+}
+
+/*------------------------------------------------------------------------*/
+/* The value of a literal is '1' if it is assigned to true, '-1' if it is
+ * assigned to false and '0' if it is unassigned.  Reading it does not
+ * touch the variable.
+ */
+static int
+lit2val (Limmat * limmat, int lit)
 {
-  return clrbit (v, ALL_BUT_SIGN_BITS);
+  assert (lit < limmat->size_values);
+
+  return limmat->values[lit];
 }
 
 /*------------------------------------------------------------------------*/
@@ -1598,6 +2000,25 @@ deref (Variable * v)
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+#ifdef TRAIL_PROPAGATION
+/*------------------------------------------------------------------------*/
+/* The assignments on the trail after position 'propagated' are assigned
+ * but not propagated yet.
+ */
+static int
+count_assignments (Limmat * limmat)
+{
+  int res;
+
+  res = count_Stack (&limmat->trail) - limmat->propagated;
+  assert (0 <= res);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+#else
 /*------------------------------------------------------------------------*/
 /* The assignments are stored in a cyclic queue.  The 'head_assignments'
  * index points to the next assignment to be dequeued, while the
@@ -1672,6 +2093,9 @@ resize_assignments (Limmat * limmat)
   limmat->head_assignments = 0;
 }
 
+/*------------------------------------------------------------------------*/
+#endif
+
 /*------------------------------------------------------------------------*/
 
 inline static void
@@ -1711,27 +2135,18 @@ fix_Stack (Stack * stack, size_t delta)
 
 /*------------------------------------------------------------------------*/
 
-static Variable **
+static int *
 clause2literals (Limmat * limmat, Clause * clause)
 {
-  Variable **res;
-
-  res = start_of_Stack (&limmat->literals);
-  res += clause->literals_idx;
-
-  return res;
+  return (int *) (clause + 1);
 }
 
 /*------------------------------------------------------------------------*/
 
-static void
-fix_clauses (Limmat * limmat, size_t delta)
+static int
+bytes_Clause (int size)
 {
-  Variable **q, **eol;
-  Clause **p, **eoc;
-
-  forall_clauses (limmat, p, eoc)
-    forall_literals (limmat, *p, q, eol) fix_pointer (q, delta);
+  return sizeof (Clause) + size * sizeof (int);
 }
 
 /*------------------------------------------------------------------------*/
@@ -1744,9 +2159,58 @@ fix_pointers_to_variables (Limmat * limmat, size_t delta)
 
   fix_variables (limmat, delta);
   fix_Stack (&limmat->order, delta);
-  fix_clauses (limmat, delta);
 }
 
+/*------------------------------------------------------------------------*/
+/* Only the clauses of the watches are pointers, see 'forall_watches'.
+ */
+static void
+fix_watches (Stack * stack, size_t delta)
+{
+  Occurence *w, *eow;
+
+  forall_watches (stack, w, eow) fix_pointer (w, delta);
+}
+
+/*------------------------------------------------------------------------*/
+/* The clause arena has been moved by 'delta' bytes.  Adjust all pointers
+ * to clauses.  Adding 'delta' keeps the sign bit of watched occurrences,
+ * since the arena is aligned.
+ */
+static void
+fix_pointers_to_clauses (Limmat * limmat, size_t delta)
+{
+#ifndef TRAIL_PROPAGATION
+  Assignment *assignment;
+  int i;
+#endif
+  Variable *v, *eov;
+
+  fix_Stack (&limmat->clauses, delta);
+  fix_Stack (&limmat->units, delta);
+
+  forall_variables (limmat, v, eov)
+  {
+    fix_watches (&v->watched[0], delta);
+    fix_watches (&v->watched[1], delta);
+
+    if (v->reason)
+      fix_pointer (&v->reason, delta);
+  }
+
+#ifndef TRAIL_PROPAGATION
+  for (i = limmat->head_assignments; i != limmat->tail_assignments;
+       i = (i + 1) % limmat->size_assignments)
+    {
+      assignment = limmat->assignments + i;
+      if (assignment->reason)
+	fix_pointer (&assignment->reason, delta);
+    }
+#endif
+}
+
+/*------------------------------------------------------------------------*/
+#ifndef TRAIL_PROPAGATION
 /*------------------------------------------------------------------------*/
 #ifndef NDEBUG
 /*------------------------------------------------------------------------*/
@@ -2099,16 +2563,32 @@ reset_assignments (Limmat * limmat)
 }
 
 /*------------------------------------------------------------------------*/
+#else
+/*------------------------------------------------------------------------*/
+/* Drop the assignments which are not propagated yet.  They are removed
+ * from the trail during backtracking.
+ */
+static void
+reset_assignments (Limmat * limmat)
+{
+  limmat->propagated = count_Stack (&limmat->trail);
+}
 
-static Statistics *
-new_Statistics (Limmat * limmat)
-{
-  Statistics *res;
-
-  res = (Statistics *) new (limmat, sizeof (Statistics));
+/*------------------------------------------------------------------------*/
+#endif
+
+/*------------------------------------------------------------------------*/
+
+static void
+init_Statistics (Statistics * res)
+{
+  int i;
 
   res->removed_clauses = 0;
   res->removed_literals = 0;
+  res->reductions = 0;
+  res->collected_bytes = 0;
+  res->blocked = 0;
 
   res->max_literals = 0;
   res->learned_literals = 0;
@@ -2117,7 +2597,7 @@ new_Statistics (Limmat * limmat)
   res->original_clauses = 0;
   res->learned_clauses = 0;
   res->max_clauses = 0;
-  res->rescored_variables = 0;
+  res->bumped = 0;
   res->sum_assigned_in_decision = 0;
   res->sum_score_in_decision = 0;
 
@@ -2131,6 +2611,25 @@ new_Statistics (Limmat * limmat)
   res->compared = 0;
   res->searched = 0;
 
+  for (i = 0; i < 3; i++)
+    res->rephased[i] = 0;
+
+  res->reused = 0;
+  res->blocked_restarts = 0;
+  res->minimized_literals = 0;
+  res->strengthened_literals = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static Statistics *
+new_Statistics (Limmat * limmat)
+{
+  Statistics *res;
+
+  res = (Statistics *) new (limmat, sizeof (Statistics));
+  init_Statistics (res);
+
   return res;
 }
 
@@ -2168,6 +2667,72 @@ foption (const char *name, double default_initialization)
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+/* The Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ... starting
+ * with index zero.
+ */
+static int
+luby (int i)
+{
+  int size, seq;
+
+  for (size = 1, seq = 0; size < i + 1; seq++)
+    size = 2 * size + 1;
+
+  while (size - 1 != i)
+    {
+      size = (size - 1) >> 1;
+      seq--;
+      i = i % size;
+    }
+
+  return 1 << seq;
+}
+
+/*------------------------------------------------------------------------*/
+/* Glucose restarts need at least this many conflicts between restarts and
+ * are only blocked after this many conflicts.
+ */
+#define MIN_RESTART_CONFLICTS 50
+#define MIN_BLOCK_CONFLICTS 10000
+
+static void
+schedule_restart (Limmat * limmat)
+{
+  double delta;
+
+  if (limmat->restart_policy == LIMMAT_LUBY_RESTARTS)
+    delta = limmat->luby_unit * (double) luby (limmat->luby_index);
+  else
+    delta = MIN_RESTART_CONFLICTS;
+
+  limmat->next_restart = limmat->num_conflicts + delta;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+init_restarts (Limmat * limmat)
+{
+  init_Counter (&limmat->restart, option ("RESTART", RESTART), 1.4142, 1);
+
+  limmat->restart_policy = option ("RESTARTPOLICY", RESTARTPOLICY);
+  if (limmat->restart_policy != LIMMAT_LUBY_RESTARTS &&
+      limmat->restart_policy != LIMMAT_GLUCOSE_RESTARTS)
+    limmat->restart_policy = LIMMAT_GEOMETRIC_RESTARTS;
+
+  limmat->luby_unit = option ("LUBY", LUBY);
+  limmat->luby_index = 0;
+  limmat->glucose_margin = foption ("GLUCOSEMARGIN", GLUCOSEMARGIN);
+  limmat->glucose_block = foption ("GLUCOSEBLOCK", GLUCOSEBLOCK);
+  limmat->fast_glue = 0;
+  limmat->slow_glue = 0;
+  limmat->trail_average = 0;
+  limmat->averaged = 0;
+
+  schedule_restart (limmat);
+}
+
 /*------------------------------------------------------------------------*/
 
 Limmat *
@@ -2182,7 +2747,10 @@ new_Limmat (FILE * log)
 
   init_Stack (res, &res->clauses);
   init_Stack (res, &res->units);
-  init_Stack (res, &res->literals);
+  init_Arena (res, &res->clause_arena, CLAUSE_ALIGNMENT);
+  res->values = 0;
+  res->size_values = 0;
+  init_Stack (res, &res->assumptions);
   res->contains_empty_clause = 0;
   res->added_clauses = 0;
   res->num_clauses = 0;
@@ -2198,23 +2766,26 @@ new_Limmat (FILE * log)
   bytes = sizeof (Frame) * res->control_size;
   res->control = (Frame *) new (res, bytes);
 
+#ifdef TRAIL_PROPAGATION
+  res->propagated = 0;
+#else
   res->size_assignments = 1;
   bytes = sizeof (Assignment) * res->size_assignments;
   res->assignments = (Assignment *) new (res, bytes);
   res->head_assignments = 0;
   res->tail_assignments = 0;
+  res->inconsistent = -1;
+#endif
 
   init_Stack (res, &res->stack);
   init_Stack (res, &res->trail);
   init_Stack (res, &res->clause);
+  init_Stack (res, &res->redundant);
   init_Stack (res, &res->order);
-  res->last_assigned_pos = -1;
-  res->first_zero_pos = 0;
   res->num_assigned = 0;
   res->max_score = 0;
   res->current_max_score = 0;
-
-  res->inconsistent = -1;
+  res->score_increment = 1;
 
   res->error = 0;
   res->time = 0;
@@ -2222,14 +2793,33 @@ new_Limmat (FILE * log)
   res->log = log;
 
   init_Counter (&res->report, 99, 1.21, 0);
-  init_Counter (&res->restart, option ("RESTART", RESTART), 1.4142, 1);
   init_Counter (&res->rescore, option ("RESCORE", RESCORE), 1, 0);
 
+  res->reduce_init = option ("REDUCE", REDUCE);
+  res->reduce_interval = res->reduce_init;
+  res->next_reduce = res->reduce_init;
+  res->stamp = 0;
+
+  res->save_phases = option ("PHASE", PHASE);
+  res->rephase_init = option ("REPHASE", REPHASE);
+  res->rephases = 0;
+  res->best_assigned = 0;
+  res->next_rephase = res->rephase_init;
+  res->reuse_trail = option ("REUSE", REUSE);
+  res->minimize = option ("MINIMIZE", MINIMIZE);
+
   res->score_factor = foption ("RESCOREFACTOR", RESCOREFACTOR);
+  res->time_limit = -1;
+  res->time_limit_check = 0;
+  res->conflict_limit = -1;
+  res->conflicts_before = 0;
+  res->memory_limit = 0;
 
   res->num_decisions = 0;
   res->num_conflicts = 0;
 
+  init_restarts (res);
+
   res->stats = 0;
   if (option ("STATISTICS", STATISTICS))
     res->stats = new_Statistics (res);
@@ -2259,10 +2849,11 @@ set_log_Limmat (Limmat * limmat, FILE * log)
 
 /*------------------------------------------------------------------------*/
 
-static int
+static double
 get_score (Variable * v)
 {
-  int res, sign;
+  double res;
+  int sign;
 
   if ((sign = is_signed (v)))
     v = not (v);
@@ -2279,7 +2870,8 @@ get_score (Variable * v)
 inline static int
 cmp (Limmat * limmat, Variable * v0, Variable * v1)
 {
-  int score[2], id[2], res;
+  double score[2];
+  int id[2], res;
 
   assert (v0 != FALSE);
   assert (v0 != TRUE);
@@ -2328,6 +2920,166 @@ cmp (Limmat * limmat, Variable * v0, Variable * v1)
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+
+inline static int
+get_pos (Variable * v)
+{
+  int sign, res;
+
+  sign = is_signed (v);
+  if (sign)
+    v = not (v);
+  res = v->pos[sign];
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+inline static void
+set_pos (Variable * v, int pos)
+{
+  int sign;
+
+  sign = is_signed (v);
+  if (sign)
+    v = not (v);
+  v->pos[sign] = pos;
+}
+
+/*------------------------------------------------------------------------*/
+/* The 'order' is a binary heap of literals with respect to 'cmp', such
+ * that the literal with the largest score is on top.  Literals of assigned
+ * variables are only removed when they reach the top in 'next_decision'
+ * and are put back during backtracking in 'untrail'.
+ */
+static void
+up_order (Limmat * limmat, Variable * v)
+{
+  Variable **heap, *parent;
+  int pos, parent_pos;
+
+  heap = (Variable **) start_of_Stack (&limmat->order);
+  pos = get_pos (v);
+  assert (0 <= pos && heap[pos] == v);
+
+  while (pos > 0)
+    {
+      parent_pos = (pos - 1) / 2;
+      parent = heap[parent_pos];
+      if (cmp (limmat, v, parent) <= 0)
+	break;
+
+      if (limmat->stats)
+	limmat->stats->swapped++;
+
+      heap[pos] = parent;
+      set_pos (parent, pos);
+      pos = parent_pos;
+    }
+
+  heap[pos] = v;
+  set_pos (v, pos);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+down_order (Limmat * limmat, Variable * v)
+{
+  int pos, child_pos, count;
+  Variable **heap, *child;
+
+  heap = (Variable **) start_of_Stack (&limmat->order);
+  count = count_Stack (&limmat->order);
+  pos = get_pos (v);
+  assert (0 <= pos && heap[pos] == v);
+
+  for (;;)
+    {
+      child_pos = 2 * pos + 1;
+      if (child_pos >= count)
+	break;
+
+      child = heap[child_pos];
+      if (child_pos + 1 < count &&
+	  cmp (limmat, heap[child_pos + 1], child) > 0)
+	child = heap[++child_pos];
+
+      if (cmp (limmat, v, child) >= 0)
+	break;
+
+      if (limmat->stats)
+	limmat->stats->swapped++;
+
+      heap[pos] = child;
+      set_pos (child, pos);
+      pos = child_pos;
+    }
+
+  heap[pos] = v;
+  set_pos (v, pos);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+push_order (Limmat * limmat, Variable * v)
+{
+  assert (get_pos (v) < 0);
+
+  set_pos (v, count_Stack (&limmat->order));
+  push (limmat, &limmat->order, v);
+  up_order (limmat, v);
+}
+
+/*------------------------------------------------------------------------*/
+
+static Variable *
+pop_order (Limmat * limmat)
+{
+  Variable *res, *last, **heap;
+
+  heap = (Variable **) start_of_Stack (&limmat->order);
+  res = heap[0];
+  last = (Variable *) pop (&limmat->order);
+  set_pos (res, -1);
+
+  if (last != res)
+    {
+      heap[0] = last;
+      set_pos (last, 0);
+      down_order (limmat, last);
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Increase the score of a literal occurring in a learned clause.
+ */
+inline static void
+bump_score (Limmat * limmat, Variable * v)
+{
+  Variable *stripped;
+  double score;
+  int sign;
+
+  stripped = (sign = is_signed (v)) ? not (v) : v;
+  score = stripped->score[sign] + limmat->score_increment;
+  stripped->score[sign] = score;
+
+  if (score > limmat->max_score)
+    limmat->max_score = score;
+
+  if (limmat->stats)
+    limmat->stats->bumped++;
+
+  if (stripped->pos[sign] >= 0)
+    up_order (limmat, v);
+}
+
 /*------------------------------------------------------------------------*/
 #ifdef EXPENSIVE_CHECKS
 /*------------------------------------------------------------------------*/
@@ -2348,7 +3100,7 @@ find_empty_clause (Limmat * limmat)
 
     for (i = 0; !found && i < num_literals; i++)
       found =
-	(deref (lit2var (clause2literals (limmat, clause)[i])) != FALSE);
+	(deref (lit2var (limmat, clause2literals (limmat, clause)[i])) != FALSE);
 
     if (!found)
       res = clause;
@@ -2384,7 +3136,7 @@ static void
 untrail (Limmat * limmat, int decision_level)
 {
   Variable **all, **start, **p, *src;
-  int lower_pos, new_trail_level;
+  int new_trail_level;
   Frame *frame;
 
   assert (decision_level <= limmat->decision_level);
@@ -2411,19 +3163,29 @@ untrail (Limmat * limmat, int decision_level)
       assert (is_assigned (src));
       assert (src->decision_level >= decision_level);
 
+      src->phase = (src->assignment == FALSE);
+      src->phased = 1;
+
       src->assignment = src;
+      limmat->values[2 * src->id] = 0;
+      limmat->values[2 * src->id + 1] = 0;
       src->reason = 0;
       src->decision_level = -1;
 
       assert (limmat->num_assigned > 0);
       limmat->num_assigned--;
 
-      lower_pos = min (src->pos[0], src->pos[1]);
-      if (lower_pos <= limmat->last_assigned_pos)
-	limmat->last_assigned_pos = lower_pos - 1;
+      if (src->pos[0] < 0)
+	push_order (limmat, src);
+      if (src->pos[1] < 0)
+	push_order (limmat, not (src));
     }
 
   reset_Stack (limmat, &limmat->trail, new_trail_level);
+#ifdef TRAIL_PROPAGATION
+  if (limmat->propagated > new_trail_level)
+    limmat->propagated = new_trail_level;
+#endif
 
 #ifdef EXPENSIVE_CHECKS
   check_no_empty_clause (limmat);
@@ -2444,14 +3206,7 @@ reset_control (Limmat * limmat)
 static void
 reset_clauses (Limmat * limmat)
 {
-  Clause *clause, **p, **eoc;
-
-  forall_clauses (limmat, p, eoc)
-  {
-    clause = *p;
-    delete (limmat, clause, sizeof (Clause));
-  }
-
+  reset_Arena (limmat, &limmat->clause_arena);
   reset_Stack (limmat, &limmat->clauses, 0);
   limmat->contains_empty_clause = 0;
 }
@@ -2478,8 +3233,6 @@ static void
 reset_order (Limmat * limmat)
 {
   reset_Stack (limmat, &limmat->order, 0);
-  limmat->last_assigned_pos = -1;
-  limmat->first_zero_pos = 0;
 }
 
 /*------------------------------------------------------------------------*/
@@ -2495,17 +3248,76 @@ reset_error (Limmat * limmat)
 }
 
 /*------------------------------------------------------------------------*/
-
+/* Reset counters and statistics to the state of a new instance.
+ */
 static void
+reset_counters (Limmat * limmat)
+{
+  limmat->added_clauses = 0;
+  limmat->num_clauses = 0;
+  limmat->max_id = 0;
+  limmat->added_literals = 0;
+  limmat->num_literals = 0;
+  limmat->num_variables = 0;
+  limmat->num_assigned = 0;
+  limmat->max_score = 0;
+  limmat->current_max_score = 0;
+  limmat->score_increment = 1;
+  limmat->num_decisions = 0;
+  limmat->num_conflicts = 0;
+  limmat->time = 0;
+  limmat->max_bytes = limmat->bytes;
+
+  init_Counter (&limmat->report, 99, 1.21, 0);
+  init_Counter (&limmat->rescore, option ("RESCORE", RESCORE), 1, 0);
+
+  limmat->reduce_init = option ("REDUCE", REDUCE);
+  limmat->reduce_interval = limmat->reduce_init;
+  limmat->next_reduce = limmat->reduce_init;
+
+  limmat->save_phases = option ("PHASE", PHASE);
+  limmat->rephase_init = option ("REPHASE", REPHASE);
+  limmat->rephases = 0;
+  limmat->best_assigned = 0;
+  limmat->next_rephase = limmat->rephase_init;
+  limmat->reuse_trail = option ("REUSE", REUSE);
+  limmat->minimize = option ("MINIMIZE", MINIMIZE);
+
+  init_restarts (limmat);
+
+  if (limmat->stats)
+    init_Statistics (limmat->stats);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
 reset_Limmat (Limmat * limmat)
 {
   reset_assignments (limmat);
   reset_Stack (limmat, &limmat->clause, 0);
   reset_control (limmat);
   reset_clauses (limmat);
+  reset_Stack (limmat, &limmat->units, 0);
+  reset_Stack (limmat, &limmat->assumptions, 0);
   reset_order (limmat);
   reset_variables (limmat);
   reset_error (limmat);
+  reset_counters (limmat);
+}
+
+/*------------------------------------------------------------------------*/
+/* After 'sat' returned, the variables are still assigned, which allows to
+ * extract the assignment.  Before the solver can be used again, for
+ * instance for adding clauses, the assignments have to be removed.  The
+ * 'clause' stack may still hold the last extracted assignment.
+ */
+static void
+reset_search (Limmat * limmat)
+{
+  reset_assignments (limmat);
+  reset_control (limmat);
+  reset_Stack (limmat, &limmat->clause, 0);
 }
 
 /*------------------------------------------------------------------------*/
@@ -2513,10 +3325,12 @@ reset_Limmat (Limmat * limmat)
 static void
 release_assignments (Limmat * limmat)
 {
+#ifndef TRAIL_PROPAGATION
   int bytes;
 
   bytes = sizeof (Assignment) * limmat->size_assignments;
   delete (limmat, limmat->assignments, bytes);
+#endif
 }
 
 /*------------------------------------------------------------------------*/
@@ -2549,10 +3363,13 @@ release_Limmat (Limmat * limmat)
   release_assignments (limmat);
   release_Stack (limmat, &limmat->stack);
   release_Stack (limmat, &limmat->clause);
+  release_Stack (limmat, &limmat->redundant);
   release_control (limmat);
   release_Stack (limmat, &limmat->clauses);
   release_Stack (limmat, &limmat->units);
-  release_Stack (limmat, &limmat->literals);
+  release_Arena (limmat, &limmat->clause_arena);
+  release_values (limmat);
+  release_Stack (limmat, &limmat->assumptions);
   release_Stack (limmat, &limmat->order);
   release_Arena (limmat, &limmat->variables);
   release_statistics (limmat);
@@ -2635,6 +3452,8 @@ new_Parser (Limmat * limmat, FILE * file, const char *input_name)
   res->num_specified_max_id = -1;
   res->limmat = limmat;
   init_Stack (limmat, &res->literals);
+  init_Stack (limmat, &res->clauses);
+  res->num_buffered = 0;
   res->lineno = 0;
   res->error = 0;
 
@@ -2686,6 +3505,7 @@ delete_Parser (Parser * parser)
     delete (parser->limmat, parser->error, ERROR_SIZE);
 
   release_Stack (parser->limmat, &parser->literals);
+  release_Stack (parser->limmat, &parser->clauses);
   delete (parser->limmat, parser, sizeof (Parser));
 }
 
@@ -2910,51 +3730,24 @@ init_Variable (Limmat * limmat, Variable * v, int id)
     {
       v->score[i] = 0;
       v->ref[i] = 0;
-      v->saved[i] = 0;
       init_Stack (limmat, &v->watched[i]);
-      v->pos[i] = 0;
+      v->pos[i] = -1;
     }
 
   v->assignment = v;
   v->reason = 0;
 
+#ifndef TRAIL_PROPAGATION
   v->pos_on_queue = -1;
   v->sign_on_queue = 0;
+#endif
 
   v->sign_in_clause = 0;
   v->mark = 0;
-}
-
-/*------------------------------------------------------------------------*/
-#ifndef NDEBUG
-/*------------------------------------------------------------------------*/
-
-inline static int
-get_pos (Variable * v)
-{
-  int sign, res;
-
-  sign = is_signed (v);
-  if (sign)
-    v = not (v);
-  res = v->pos[sign];
-
-  return res;
-}
-
-/*------------------------------------------------------------------------*/
-#endif
-/*------------------------------------------------------------------------*/
-
-inline static void
-set_pos (Variable * v, int pos)
-{
-  int sign;
-
-  sign = is_signed (v);
-  if (sign)
-    v = not (v);
-  v->pos[sign] = pos;
+  v->phased = 0;
+  v->phase = 0;
+  v->bested = 0;
+  v->best = 0;
 }
 
 /*------------------------------------------------------------------------*/
@@ -2962,22 +3755,11 @@ set_pos (Variable * v, int pos)
 inline static void
 insert_order (Limmat * limmat, Variable * v)
 {
-  /* Since we assume that an unsigned variables is smaller than the same
-   * signed variable and the larger variables should occur before smaller in
-   * the order, we put 'not(v)' before 'v' in the order.
-   */
-  assert (cmp (0, v, not (v)) < 0);
-
-  set_pos (not (v), count_Stack (&limmat->order));
-  push (limmat, &limmat->order, not (v));
-
-  set_pos (v, count_Stack (&limmat->order));
-  push (limmat, &limmat->order, v);
-
-  /* Otherwise we have to update 'limmat->first_zero_pos'.
-   */
   assert (!v->score[0]);
   assert (!v->score[1]);
+
+  push_order (limmat, not (v));
+  push_order (limmat, v);
 }
 
 /*------------------------------------------------------------------------*/
@@ -3000,6 +3782,7 @@ find (Limmat * l, int id)
 
   if (fresh)
     {
+      reserve_values (l, id);
       init_Variable (l, res, id);
       if (delta)
 	fix_pointer (&res->assignment, -delta);
@@ -3052,25 +3835,67 @@ clause2watched (Clause * c)
 }
 
 /*------------------------------------------------------------------------*/
-
-inline static void
-connect (Limmat * limmat, Clause * clause, int l)
+/* If the blocking literal of a watch is true, the clause is satisfied and
+ * the watch can be skipped without accessing the clause.  For binary
+ * clauses the blocking literal is the other literal and never changes.
+ */
+inline static int
+get_blocker (Occurence * watch)
 {
-  Variable *v, **literals;
-  Occurence occurrence;
-  Clause *stripped;
-  int vs;
+  return (int) ((PTR_SIZED_WORD) watch[1] >> WATCH_KIND_BITS);
+}
 
-  /* Get the corresponding variable and its sign at position 'l' in 'clause'.
-   */
-  int *watched;
+/*------------------------------------------------------------------------*/
 
-  stripped = strip (clause);
+inline static int
+get_watch_kind (Occurence * watch)
+{
+  return (int) ((PTR_SIZED_WORD) watch[1] &
+		((1 << WATCH_KIND_BITS) - 1));
+}
 
-  assert (stripped->size > l);
-  literals = clause2literals (limmat, stripped);
-  v = lit2var (literals[l]);
-  if ((vs = is_signed (v)))
+/*------------------------------------------------------------------------*/
+
+inline static void
+set_blocker (Occurence * watch, int blocker)
+{
+  watch[1] = (Occurence) (((PTR_SIZED_WORD) blocker << WATCH_KIND_BITS) |
+			  get_watch_kind (watch));
+}
+
+/*------------------------------------------------------------------------*/
+
+inline static void
+push_watch (Limmat * limmat,
+	    Stack * stack, Occurence occurrence, int blocker, int kind)
+{
+  push (limmat, stack, occurrence);
+  push (limmat, stack,
+	(void *) (((PTR_SIZED_WORD) blocker << WATCH_KIND_BITS) | kind));
+}
+
+/*------------------------------------------------------------------------*/
+/* The blocking literal of a new watch is the other watched literal if
+ * there is one already, otherwise another literal of the clause.
+ */
+inline static void
+connect (Limmat * limmat, Clause * clause, int l)
+{
+  int vs, *literals, other, blocker;
+  Occurence occurrence;
+  Clause *stripped;
+  Variable *v;
+
+  /* Get the corresponding variable and its sign at position 'l' in 'clause'.
+   */
+  int *watched;
+
+  stripped = strip (clause);
+
+  assert (stripped->size > l);
+  literals = clause2literals (limmat, stripped);
+  v = lit2var (limmat, literals[l]);
+  if ((vs = is_signed (v)))
     v = not (v);
 
   /* Mark this literal as watched in the clause.
@@ -3080,33 +3905,71 @@ connect (Limmat * limmat, Clause * clause, int l)
   *watched = l;
   occurrence = clause;
 
+  other = *clause2watched (not (clause));
+  if (other >= 0)
+    blocker = literals[other];
+  else if (stripped->size > 1)
+    blocker = literals[l ? 0 : 1];
+  else
+    blocker = literals[l];
+
   /* Finally enqueue this occurence to the variable.
    */
-  push (limmat, &v->watched[vs], occurrence);
+  push_watch (limmat, &v->watched[vs], occurrence, blocker,
+	      (stripped->size == 2) ? BINARY_WATCH : LONG_WATCH);
 
 #ifdef LOG_CONNECT
   fprintf (LOGFILE (limmat),
 	   "CONNECT\t%d\t%u\n",
-	   var2int (lit2var (literals[l])), count_Stack (&v->watched[vs]));
+	   var2int (lit2var (limmat, literals[l])), count_Stack (&v->watched[vs]));
 #endif
 }
 
+/*------------------------------------------------------------------------*/
+/* Ternary clauses are watched on all of their three literals.  Their
+ * watches never move, since a clause is visited whenever one of its
+ * literals becomes false.  The watched literals of the clause itself are
+ * not used.
+ */
+static void
+connect_ternary (Limmat * limmat, Clause * clause)
+{
+  int l, vs, *literals;
+  Variable *v;
+
+  assert (clause->size == 3);
+  literals = clause2literals (limmat, clause);
+
+  for (l = 0; l < 3; l++)
+    {
+      v = lit2var (limmat, literals[l]);
+      if ((vs = is_signed (v)))
+	v = not (v);
+
+      push_watch (limmat, &v->watched[vs], clause,
+		  literals[l ? 0 : 1], TERNARY_WATCH);
+
+#ifdef LOG_CONNECT
+      fprintf (LOGFILE (limmat),
+	       "CONNECT\t%d\t%u\n",
+	       var2int (lit2var (limmat, literals[l])),
+	       count_Stack (&v->watched[vs]));
+#endif
+    }
+}
+
 /*------------------------------------------------------------------------*/
 
 static void
 partial_disconnect (Limmat * limmat, Clause * clause, int l)
 {
-  Variable **literals;
-  Clause *stripped;
   int *watched;
 
   /* Mark the literal as watched in the clause.
    */
   watched = clause2watched (clause);
   assert (*watched == l);
-  stripped = strip (clause);
-  assert (stripped->size > l);
-  literals = clause2literals (limmat, stripped);
+  assert (((Clause *) strip (clause))->size > l);
   *watched = -1;
 }
 
@@ -3117,17 +3980,71 @@ partial_disconnect (Limmat * limmat, Clause * clause, int l)
 static int
 is_connected (Variable * v, Clause * clause)
 {
-  Clause **p, **end;
+  Occurence *p, *end;
   int res;
 
   res = 0;
 
-  forall_Stack (var2stack (v), Clause *, p, end) if ((res = (*p == clause)))
+  forall_watches (var2stack (v), p, end) if ((res = (*p == clause)))
     break;
 
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+#endif
+/*------------------------------------------------------------------------*/
+#ifdef CHECK_CONSISTENCY
+/*------------------------------------------------------------------------*/
+/* A watched literal may be false while the other watched literal is not
+ * true, if propagation skipped the clause because of a true blocking
+ * literal.  This literal has been assigned before the watched literal.
+ */
+static int
+is_blocked (Limmat * limmat, Clause * clause, Variable * watched)
+{
+  int *p, *eol, res;
+  Variable *v;
+
+  res = 0;
+
+  forall_literals (limmat, clause, p, eol)
+  {
+    if (lit2val (limmat, *p) <= 0)
+      continue;
+
+    v = strip (lit2var (limmat, *p));
+    if ((res = (v->decision_level <= watched->decision_level)))
+      break;
+  }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+#ifdef TRAIL_PROPAGATION
+/*------------------------------------------------------------------------*/
+/* With 'TRAIL_PROPAGATION' a watched literal may also be false because it
+ * is assigned but not propagated yet.
+ */
+static int
+is_pending (Limmat * limmat, Variable * v)
+{
+  Variable **p, **eot;
+
+  eot = (Variable **) end_of_Stack (&limmat->trail);
+  for (p = (Variable **) start_of_Stack (&limmat->trail) +
+       limmat->propagated; p < eot; p++)
+    if (*p == v)
+      return 1;
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+#else
+#define is_pending(limmat,v) 0
+#endif
 /*------------------------------------------------------------------------*/
 #endif
 /*------------------------------------------------------------------------*/
@@ -3136,14 +4053,19 @@ static void
 invariant_clause (Limmat * limmat, Clause * clause)
 {
 #ifdef CHECK_CONSISTENCY
-  Variable *v, **literals, *tmp, *l[2], *d[2], *s[2];
-  int i, num_non_false, p[2];
+  Variable *v, *tmp, *l[2], *d[2], *s[2];
+  int i, num_non_false, p[2], *literals, b[2];
 
   assert (clause->size >= 1);
 
   if (!check_it_now (limmat))
     return;
 
+  /* Ternary clauses do not use their watched literals.
+   */
+  if (clause->size == 3)
+    return;
+
   p[0] = clause->watched[0];
   p[1] = clause->watched[1];
 
@@ -3160,28 +4082,32 @@ invariant_clause (Limmat * limmat, Clause * clause)
       num_non_false = 0;
       for (i = 0; i < clause->size; i++)
 	{
-	  v = lit2var (literals[i]);
+	  v = lit2var (limmat, literals[i]);
 	  tmp = deref (v);
 	  if (tmp != FALSE)
 	    num_non_false++;
 	}
 
-      l[0] = lit2var (literals[p[0]]);
-      l[1] = lit2var (literals[p[1]]);
+      l[0] = lit2var (limmat, literals[p[0]]);
+      l[1] = lit2var (limmat, literals[p[1]]);
       d[0] = deref (l[0]);
       d[1] = deref (l[1]);
       s[0] = strip (l[0]);
       s[1] = strip (l[1]);
+      b[0] = (d[0] == FALSE && (is_blocked (limmat, clause, s[0]) ||
+				is_pending (limmat, s[0])));
+      b[1] = (d[1] == FALSE && (is_blocked (limmat, clause, s[1]) ||
+				is_pending (limmat, s[1])));
 
       if (num_non_false >= 2)
 	{
-	  if (d[0] == FALSE)
+	  if (d[0] == FALSE && !b[0])
 	    {
 	      assert (d[1] == TRUE);
 	      assert (s[0]->decision_level >= s[1]->decision_level);
 	    }
 
-	  if (d[1] == FALSE)
+	  if (d[1] == FALSE && !b[1])
 	    {
 	      assert (d[0] == TRUE);
 	      assert (s[1]->decision_level >= s[0]->decision_level);
@@ -3198,19 +4124,20 @@ invariant_clause (Limmat * limmat, Clause * clause)
 	  assert (is_connected (l[0], clause));
 #endif
 
-	  assert ((d[0] == FALSE) + (d[1] == FALSE) == 1);
+	  if (!b[0] && !b[1])
+	    assert ((d[0] == FALSE) + (d[1] == FALSE) == 1);
 	}
 
       for (i = 0; i < clause->size; i++)
 	{
-	  v = strip (lit2var (literals[i]));
+	  v = strip (lit2var (limmat, literals[i]));
 
 	  if (i != p[0] && i != p[1])
 	    {
-	      if (d[0] == FALSE && d[1] != TRUE)
+	      if (d[0] == FALSE && d[1] != TRUE && !b[0])
 		assert (v->decision_level <= s[0]->decision_level);
 
-	      if (d[1] == FALSE && d[0] != TRUE)
+	      if (d[1] == FALSE && d[0] != TRUE && !b[1])
 		assert (v->decision_level <= s[1]->decision_level);
 	    }
 	}
@@ -3231,7 +4158,8 @@ invariant (Limmat * limmat)
 #ifdef EXPENSIVE_CHECKS
   Variable *v, *eov, *u, **order;
   Clause **p, **eoc, *clause;
-  int i, score, *watched;
+  Occurence *w, *eow;
+  int i, pos, *watched;
 
 
   if (!check_it_now (limmat))
@@ -3251,21 +4179,26 @@ invariant (Limmat * limmat)
       {
 	u = (i ? not (v) : v);
 
-	assert (order[get_pos (u)] == u);
-
-	if (!is_assigned (u))
-	  assert (limmat->last_assigned_pos < get_pos (u));
+	pos = get_pos (u);
+	if (pos >= 0)
+	  {
+	    assert (order[pos] == u);
+	    if (pos > 0)
+	      assert (cmp (0, order[(pos - 1) / 2], u) > 0);
+	  }
+	else
+	  assert (is_assigned (u));
 
-	score = get_score (u);
-	assert (score >= 0);
-	if (score)
-	  assert (limmat->first_zero_pos > get_pos (u));
+	assert (get_score (u) >= 0);
 
-	forall_Stack (&v->watched[i], Clause *, p, eoc)
+	forall_watches (&v->watched[i], w, eow)
 	{
-	  watched = clause2watched (*p);
-	  clause = strip (*p);
-	  assert (lit2var (clause2literals (limmat, clause)[*watched]) == u);
+	  if (get_watch_kind (w) == TERNARY_WATCH)
+	    continue;
+
+	  watched = clause2watched (*w);
+	  clause = strip (*w);
+	  assert (lit2var (limmat, clause2literals (limmat, clause)[*watched]) == u);
 	}
       }
   }
@@ -3284,10 +4217,10 @@ is_unique_clause (Limmat * limmat, Clause * clause)
 
   for (i = 0, res = 1; res && i < clause->size - 1; i++)
     {
-      u = strip (lit2var (clause2literals (limmat, clause)[i]));
+      u = strip (lit2var (limmat, clause2literals (limmat, clause)[i]));
       for (j = i + 1; res && j < clause->size; j++)
 	{
-	  v = strip (lit2var (clause2literals (limmat, clause)[j]));
+	  v = strip (lit2var (limmat, clause2literals (limmat, clause)[j]));
 	  res = (u->id != v->id);
 	}
     }
@@ -3312,6 +4245,7 @@ add_clause (Limmat * limmat,
   Variable *v, *stripped_literal;
   Statistics *stats;
   Clause *clause;
+  size_t delta;
 
   assert (n > 0);
 
@@ -3337,13 +4271,22 @@ add_clause (Limmat * limmat,
 	stats->max_literals = limmat->num_literals;
     }
 
-  /* Then we allocate the clause and initialize some of its components.
+  /* Then we allocate the clause in the clause arena and initialize some of
+   * its components.
    */
-  clause = (Clause *) new (limmat, sizeof (Clause));
+  clause = (Clause *)
+    alloc_Arena (limmat, &limmat->clause_arena, bytes_Clause (n), &delta);
+  if (delta)
+    fix_pointers_to_clauses (limmat, delta);
+
   clause->id = count_Stack (&limmat->clauses);
   push (limmat, &limmat->clauses, clause);
   clause->learned = 0;
+  clause->locked = 0;
+  clause->garbage = 0;
   clause->size = n;
+  clause->glue = 0;
+  clause->activity = 0;
 
   clause->watched[0] = -1;
   clause->watched[1] = -1;
@@ -3351,28 +4294,10 @@ add_clause (Limmat * limmat,
   clause->direction = 1;
 #endif
 
-  clause->literals_idx = count_Stack (&limmat->literals);
-
-  /* Push first literal of clause onto literals stack.
-   */
-  v = variables[0];
-  push (limmat, &limmat->literals, v);
-
-  /* Push inner literals.
-   */
-  for (i = 1; i < n - 1; i++)
-    {
-      v = variables[i];
-      push (limmat, &limmat->literals, v);
-    }
-
-  /* Push last literal.
+  /* The literals are stored right after the clause header.
    */
-  if (n > 1)
-    {
-      v = variables[n - 1];
-      push (limmat, &limmat->literals, v);
-    }
+  for (i = 0; i < n; i++)
+    clause2literals (limmat, clause)[i] = var2lit (variables[i]);
 
   /* Finally we have to find two literals that are assigned at the largest
    * decision level or are still unassigned.  We start with the first
@@ -3406,7 +4331,8 @@ add_clause (Limmat * limmat,
    * literal.
    */
   assert (watched[0] >= 0);
-  connect (limmat, clause, watched[0]);
+  if (n != 3)
+    connect (limmat, clause, watched[0]);
 
   /* This previously choosen literal will necessarily be also the conflict
    * driven assignment in case we want to generate one.
@@ -3456,7 +4382,10 @@ add_clause (Limmat * limmat,
       /* Connect the second watched literal.
        */
       assert (watched[1] >= 0);
-      connect (limmat, not (clause), watched[1]);
+      if (n == 3)
+	connect_ternary (limmat, clause);
+      else
+	connect (limmat, not (clause), watched[1]);
 
       if (conflict_driven_assignment)
 	{
@@ -3498,7 +4427,11 @@ add_clause (Limmat * limmat,
     }
 
   for (i = 0; i < n; i++)
-    inc_ref (limmat, variables[i]);
+    {
+      inc_ref (limmat, variables[i]);
+      if (conflict_driven_assignment)
+	bump_score (limmat, variables[i]);
+    }
 
   invariant_clause (limmat, clause);
 
@@ -3524,7 +4457,7 @@ print_clause (FILE * file, Limmat * limmat, Clause * clause)
 
   for (i = 0; i < clause->size; i++)
     fprintf (file, "%d ",
-	     var2int (lit2var (clause2literals (limmat, clause)[i])));
+	     var2int (lit2var (limmat, clause2literals (limmat, clause)[i])));
 
   fprintf (file, "0\n");
 }
@@ -3547,7 +4480,7 @@ real_max_id (Limmat * limmat)
 
     for (i = 0; i < num_literals; i++)
       {
-	v = strip (lit2var (clause2literals (limmat, clause)[i]));
+	v = strip (lit2var (limmat, clause2literals (limmat, clause)[i]));
 	if (v->id > res)
 	  res = v->id;
       }
@@ -3600,8 +4533,8 @@ dump_clause_aux (FILE * file,
 		 int negate_literals,
 		 int print_level, int print_assignment, int print_connection)
 {
-  Variable *v, *tmp, *stripped, **literals, *l;
-  int i;
+  Variable *v, *tmp, *stripped;
+  int i, *literals;
 
   if (!file)
     file = stdout;
@@ -3612,8 +4545,7 @@ dump_clause_aux (FILE * file,
 
       for (i = 0; i < clause->size; i++)
 	{
-	  l = literals[i];
-	  v = lit2var (l);
+	  v = lit2var (limmat, literals[i]);
 
 	  if (v != exception)
 	    {
@@ -3693,12 +4625,9 @@ dump_control (Limmat * limmat)
 }
 
 /*------------------------------------------------------------------------*/
-
-#define ASSIGNED_MSG "------------------ assigned variables\n"
-#define ZERO_MSG "------------------ zero score variables\n"
-
-/*------------------------------------------------------------------------*/
-
+/* Print the heap in the order of positions.  Literals of assigned
+ * variables, which are still on the heap, are marked with '*'.
+ */
 void
 dump_order (Limmat * limmat)
 {
@@ -3708,15 +4637,8 @@ dump_order (Limmat * limmat)
   i = 0;
 
   forall_Stack (&limmat->order, Variable *, p, eoo)
-  {
-    if (i - 1 == limmat->last_assigned_pos)
-      printf (ASSIGNED_MSG);
-
-    printf ("%d %d %d\n", i++, var2int (*p), get_score (*p));
-
-    if (i == limmat->first_zero_pos)
-      printf (ZERO_MSG);
-  }
+    printf ("%d %d %g%s\n", i++, var2int (*p), get_score (*p),
+	    is_assigned (*p) ? " *" : "");
 }
 
 /*------------------------------------------------------------------------*/
@@ -3771,58 +4693,96 @@ unique_literals (Variable ** literals, int n)
 /*------------------------------------------------------------------------*/
 
 void
-add_Limmat (Limmat * limmat, const int *ivec)
+add_clauses_Limmat (Limmat * limmat,
+		    const int *clauses, int num_clauses, int trusted)
 {
-  int i, n, max, tmp, old_literals_count;
+  int i, n, len, max, tmp, num_literals, old_literals_count;
   Variable **vvec, *v;
+  const int *p;
+  size_t delta;
 
-  assert (ivec);
+  assert (clauses);
+  assert (num_clauses >= 0);
+
+  if (!num_clauses)
+    return;
 
+  reset_search (limmat);
   old_literals_count = count_Stack (&limmat->clause);
 
-  /* First find the the maximal id of a variable int the new clause.
+  /* First find the the maximal id of a variable and the number of literals
+   * in all the new clauses.
    */
-  for (n = 0, max = 0; ivec[n]; n++)
-    {
-      tmp = ivec[n];
-      if (tmp < 0)
-	tmp = -tmp;
-      if (tmp > max)
-	max = tmp;
-    }
+  max = 0;
+  num_literals = 0;
+
+  for (i = 0, p = clauses; i < num_clauses; i++, p++)
+    for (; *p; p++)
+      {
+	tmp = *p;
+	if (tmp < 0)
+	  tmp = -tmp;
+	if (tmp > max)
+	  max = tmp;
+	num_literals++;
+      }
 
-  if (n)
+  /* Then access the variable with the largest index first, such that
+   * further access to variables in these clauses do not require resizing
+   * the variables arena, which would result in invalidating the previously
+   * generated variable pointers.  Also make room for the order of all
+   * variables and all the new clauses and literals at once.
+   */
+  if (max)
     {
-      /* Then access the variable with the largest index first, such that
-       * further access to variables in this clause do not require resizing
-       * the variables arena, which would result in invalidating the
-       * previously generated variable pointers.
-       */
-      assert (max > 0);
+      reserve_Stack (limmat, &limmat->order, 2 * max);
       (void) find (limmat, max);
+    }
 
-      /* Now we can savely generate variable pointers in turn, since the
-       * variable arena should already be large enough to hold all variables
-       * of this clause and will not move.
-       */
-      for (i = 0; i < n; i++)
+  reserve_Stack (limmat, &limmat->clauses,
+		 count_Stack (&limmat->clauses) + num_clauses);
+  reserve_Arena (limmat, &limmat->clause_arena,
+		 num_clauses * bytes_Clause (0) + bytes_Clause (num_literals) -
+		 bytes_Clause (0), &delta);
+  if (delta)
+    fix_pointers_to_clauses (limmat, delta);
+
+  /* Now we can savely generate variable pointers in turn, since the
+   * variable arena should already be large enough to hold all variables of
+   * these clauses and will not move.
+   */
+  for (i = 0, p = clauses; i < num_clauses; i++, p += len + 1)
+    {
+      for (len = 0; p[len]; len++)
 	{
-	  v = find (limmat, ivec[i]);
+	  v = find (limmat, p[len]);
 	  push (limmat, &limmat->clause, v);
 	}
 
+      if (!len)
+	{
+	  reset_Limmat (limmat);
+	  limmat->contains_empty_clause = 1;
+	  break;
+	}
+
       vvec = (Variable **) start_of_Stack (&limmat->clause);
       vvec += old_literals_count;
-      n = unique_literals (vvec, n);
+
+      /* Trusted clauses contain neither duplicated literals nor a literal
+       * and its negation.
+       */
+      if (trusted)
+	n = len;
+      else
+	n = unique_literals (vvec, len);
+
       assert (n != 0);
 
       if (n > 0)
 	add_clause (limmat, vvec, n, 0);
-    }
-  else
-    {
-      reset_Limmat (limmat);
-      limmat->contains_empty_clause = 1;
+
+      reset_Stack (limmat, &limmat->clause, old_literals_count);
     }
 
   reset_Stack (limmat, &limmat->clause, old_literals_count);
@@ -3830,10 +4790,40 @@ add_Limmat (Limmat * limmat, const int *ivec)
 
 /*------------------------------------------------------------------------*/
 
+void
+add_Limmat (Limmat * limmat, const int *ivec)
+{
+  assert (ivec);
+
+  add_clauses_Limmat (limmat, ivec, 1, 0);
+}
+
+/*------------------------------------------------------------------------*/
+
+/* Read clauses are added in chunks of at least this many literals.
+ */
+#define READ_CHUNK_SIZE (1 << 16)
+
+static void
+flush_clauses (Parser * parser)
+{
+  if (!parser->num_buffered)
+    return;
+
+  add_clauses_Limmat (parser->limmat, intify_Stack (&parser->clauses),
+		      parser->num_buffered, 0);
+
+  reset_Stack (parser->limmat, &parser->clauses, 0);
+  parser->num_buffered = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
 int
 read_Limmat (Limmat * limmat, FILE * file, const char *name)
 {
   int res, n, num_literals, num_clauses;
+  void **p, **end;
   Parser *parser;
 
   start_timer (&limmat->timer);
@@ -3847,10 +4837,18 @@ read_Limmat (Limmat * limmat, FILE * file, const char *name)
       n = count_Stack (&parser->literals);
       num_clauses++;
       num_literals += n;
-      push (limmat, &parser->literals, (void *) (int) 0);
-      add_Limmat (limmat, intify_Stack (&parser->literals));
+
+      forall_Stack (&parser->literals, void *, p, end)
+	push (limmat, &parser->clauses, *p);
+      push (limmat, &parser->clauses, (void *) (PTR_SIZED_WORD) 0);
+      parser->num_buffered++;
+
+      if (!n || count_Stack (&parser->clauses) >= READ_CHUNK_SIZE)
+	flush_clauses (parser);
     }
 
+  flush_clauses (parser);
+
   if (!parser->error &&
       !limmat->contains_empty_clause && parser->num_specified_clauses >= 0)
     {
@@ -3942,6 +4940,14 @@ bytes_Limmat (Limmat * limmat)
 
 /*------------------------------------------------------------------------*/
 
+size_t
+max_bytes_Limmat (Limmat * limmat)
+{
+  return limmat->max_bytes;
+}
+
+/*------------------------------------------------------------------------*/
+
 static void
 stats_performance (const char *description,
 		   double absolute_value, double time, FILE * file)
@@ -3964,7 +4970,7 @@ void
 stats_Limmat (Limmat * limmat, FILE * file)
 {
   double avg_num, avg_original, avg_learned, avg_max, avg_added, avg_removed;
-  double avg_rescored_variables, avg_assigned_in_decision;
+  double avg_bumped, avg_assigned_in_decision;
   double bytes, H, M, S, MB, KB;
   double avg_score_in_decision;
   Statistics *stats;
@@ -4023,6 +5029,7 @@ stats_Limmat (Limmat * limmat, FILE * file)
       stats_performance ("propagations", stats->propagations, limmat->time,
 			 file);
       stats_performance ("visits", stats->visits, limmat->time, file);
+      stats_performance ("blocked", stats->blocked, limmat->time, file);
       stats_performance ("compared", stats->compared, limmat->time, file);
       stats_performance ("swapped", stats->swapped, limmat->time, file);
       stats_performance ("searched", stats->searched, limmat->time, file);
@@ -4031,22 +5038,48 @@ stats_Limmat (Limmat * limmat, FILE * file)
 
       fprintf (file,
 	       LIMMAT_PREFIX
-	       "%.0f restarts, %.0f rescores\n",
-	       limmat->restart.finished, limmat->rescore.finished);
+	       "%.0f restarts (%.0f levels reused, %.0f blocked), "
+	       "%.0f rescores\n",
+	       limmat->restart.finished, stats->reused,
+	       stats->blocked_restarts, limmat->rescore.finished);
+
+      fprintf (file,
+	       LIMMAT_PREFIX "%.0f reductions, %.0f bytes collected\n",
+	       stats->reductions, stats->collected_bytes);
+
+      fprintf (file,
+	       LIMMAT_PREFIX
+	       "%.0f rephases (%.0f original, %.0f inverted, %.0f best)\n",
+	       stats->rephased[ORIGINAL_PHASES] +
+	       stats->rephased[INVERTED_PHASES] +
+	       stats->rephased[BEST_PHASES],
+	       stats->rephased[ORIGINAL_PHASES],
+	       stats->rephased[INVERTED_PHASES], stats->rephased[BEST_PHASES]);
+
+      fprintf (file,
+	       LIMMAT_PREFIX "%.0f blocked watches (%.0f%% of watches)\n",
+	       stats->blocked,
+	       (stats->blocked + stats->propagations) ?
+	       100.0 * stats->blocked / (stats->blocked +
+					 stats->propagations) : 0.0);
 
       fprintf (file,
 	       LIMMAT_PREFIX "%.0f uips, %.0f backjumps\n",
 	       stats->uips, stats->backjumps);
 
+      fprintf (file,
+	       LIMMAT_PREFIX
+	       "%.0f minimized literals, %.0f strengthened literals\n",
+	       stats->minimized_literals, stats->strengthened_literals);
+
       fputs (LIMMAT_PREFIX "\n", file);
 
       if (limmat->rescore.finished)
 	{
-	  avg_rescored_variables =
-	    stats->rescored_variables / limmat->rescore.finished;
+	  avg_bumped = stats->bumped / limmat->rescore.finished;
 	}
       else
-	avg_rescored_variables = 0;
+	avg_bumped = 0;
 
       if (limmat->num_decisions)
 	{
@@ -4063,13 +5096,13 @@ stats_Limmat (Limmat * limmat, FILE * file)
 	       LIMMAT_PREFIX
 	       "average %.0f assigned variables per decision\n"
 	       LIMMAT_PREFIX
-	       "average %.1f variables rescored per decision\n"
+	       "average %.1f literals bumped per rescore\n"
 	       LIMMAT_PREFIX
 	       "average %.1f maximal score per decision\n"
 	       LIMMAT_PREFIX
-	       "maximal %d score\n",
+	       "maximal %g score\n",
 	       avg_assigned_in_decision,
-	       avg_rescored_variables,
+	       avg_bumped,
 	       avg_score_in_decision, limmat->max_score);
 
       fprintf (file,
@@ -4211,9 +5244,14 @@ strategy_Limmat (Limmat * limmat, FILE * file)
 
   fputs (LIMMAT_PREFIX
 #ifdef LOOK_AT_OTHER_WATCHED_LITERAL
-	 "+LOOK_AT_OTHER_WATCHED_LITERAL"
+	 "+LOOK_AT_OTHER_WATCHED_LITERAL "
+#else
+	 "-LOOK_AT_OTHER_WATCHED_LITERAL "
+#endif
+#ifdef TRAIL_PROPAGATION
+	 "+TRAIL_PROPAGATION"
 #else
-	 "-LOOK_AT_OTHER_WATCHED_LITERAL"
+	 "-TRAIL_PROPAGATION"
 #endif
 	 "\n", file);
 
@@ -4221,8 +5259,24 @@ strategy_Limmat (Limmat * limmat, FILE * file)
 	   LIMMAT_PREFIX
 	   "RESTART=%d "
 	   "RESCORE=%d "
-	   "RESCOREFACTOR=%f\n", 
-	   limmat->restart.init, limmat->rescore.init,limmat->score_factor);
+	   "RESCOREFACTOR=%f "
+	   "REDUCE=%d "
+	   "PHASE=%d "
+	   "REPHASE=%d "
+	   "REUSE=%d "
+	   "MINIMIZE=%d\n",
+	   limmat->restart.init, limmat->rescore.init,limmat->score_factor,
+	   limmat->reduce_init, limmat->save_phases, limmat->rephase_init,
+	   limmat->reuse_trail, limmat->minimize);
+
+  fprintf (file,
+	   LIMMAT_PREFIX
+	   "RESTARTPOLICY=%d "
+	   "LUBY=%d "
+	   "GLUCOSEMARGIN=%f "
+	   "GLUCOSEBLOCK=%f\n",
+	   limmat->restart_policy, limmat->luby_unit,
+	   limmat->glucose_margin, limmat->glucose_block);
 
   limmat->time += stop_timer (limmat->timer);
 }
@@ -4257,6 +5311,11 @@ options_Limmat (void)
     "1"
 #else
     "0"
+#endif
+#ifdef TRAIL_PROPAGATION
+    "1"
+#else
+    "0"
 #endif
     ;
 }
@@ -4285,6 +5344,7 @@ push_frame (Limmat * limmat, Variable * assignment)
   frame->decision = assignment;
   frame->decision_level = limmat->decision_level;
   frame->trail_level = count_Stack (&limmat->trail);
+  frame->stamp = 0;
 }
 
 /*------------------------------------------------------------------------*/
@@ -4328,12 +5388,48 @@ assign (Limmat * limmat, Assignment * assignment)
   stripped = sign ? not (literal) : literal;
 
   stripped->assignment = (sign ? FALSE : TRUE);
+  limmat->values[2 * stripped->id + sign] = 1;
+  limmat->values[2 * stripped->id + !sign] = -1;
   stripped->decision_level = assignment->decision_level;
   stripped->reason = assignment->reason;
 
   push (limmat, &limmat->trail, stripped);
 }
 
+/*------------------------------------------------------------------------*/
+#ifdef TRAIL_PROPAGATION
+/*------------------------------------------------------------------------*/
+/* Assign the literal right away.  It is propagated later, when 'propagate'
+ * reaches it on the trail.  Propagation never schedules literals which are
+ * already assigned, except for units, where a conflicting unit is found
+ * through the watch of the other unit clause.
+ */
+static void
+push_assignment (Limmat * limmat, Assignment * assignment)
+{
+  Variable *tmp;
+
+#ifdef LOG_PUSH
+  static int counter = 0;
+  fprintf (LOGFILE (limmat), "PUSH\t%d\t%d\t%d\n",
+	   counter++, var2int (assignment->literal),
+	   count_assignments (limmat));
+#endif
+
+  tmp = deref (assignment->literal);
+  if (tmp == TRUE || tmp == FALSE)
+    {
+      assert (!assignment->reason);
+      assert (assignment->decision_level < 0);
+      return;
+    }
+
+  assign (limmat, assignment);
+}
+
+/*------------------------------------------------------------------------*/
+#endif
+
 /*------------------------------------------------------------------------*/
 
 static void
@@ -4392,311 +5488,101 @@ one_line_stats (Limmat * limmat)
 }
 
 /*------------------------------------------------------------------------*/
-
+/* Remove literals of assigned variables from the top of the heap until an
+ * unassigned literal is found.  This literal is removed as well, since it
+ * is about to be assigned.  With phase saving only its variable is taken
+ * from the heap and assigned to its saved phase.
+ */
 static Variable *
 next_decision (Limmat * limmat)
 {
-  Variable *res, *tmp, **order;
+  Variable *res, *stripped;
   Statistics *stats;
-  int pos, score;
 
   assert (limmat->num_assigned < limmat->num_variables);
 
   stats = limmat->stats;
-  pos = limmat->last_assigned_pos + 1;
-  order = (Variable **) start_of_Stack (&limmat->order);
 
-  /* Find a still unassigned variable at 'pos' or above.
-   */
-  res = 0;
-  while (pos < count_Stack (&limmat->order) && !res)
+  do
     {
-      tmp = order[pos];
-      if (is_assigned (tmp))
-	{
-	  pos++;
-	  if (stats)
-	    stats->searched++;
-	}
-      else
-	res = tmp;
+      assert (count_Stack (&limmat->order) > 0);
+      res = pop_order (limmat);
+      if (stats && is_assigned (res))
+	stats->searched++;
     }
+  while (is_assigned (res));
 
-  assert (res);
-  score = get_score (res);
-  limmat->current_max_score = score;
-  limmat->last_assigned_pos = pos - 1;
+  limmat->current_max_score = get_score (res);
+
+  stripped = strip (res);
+  if (limmat->save_phases && stripped->phased)
+    res = stripped->phase ? not (stripped) : stripped;
 
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+#if !defined(NDEBUG) || defined(LIMMAT_WHITE)
 /*------------------------------------------------------------------------*/
 
-inline static void
-swap (Limmat * limmat, Variable ** a, Variable ** b)
+static int
+is_heap (Limmat * limmat)
 {
-  Variable *tmp;
+  Variable **order;
+  int i, count, res;
 
-  if (limmat && limmat->stats)
-    limmat->stats->swapped++;
+  order = start_of_Stack (&limmat->order);
+  count = count_Stack (&limmat->order);
+
+  for (i = 0, res = 1; res && i < count; i++)
+    {
+      res = (get_pos (order[i]) == i);
+      if (res && i > 0)
+	res = (cmp (0, order[(i - 1) / 2], order[i]) > 0);
+    }
 
-  tmp = *a;
-  *a = *b;
-  *b = tmp;
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
-
-inline static void
-cmpswap (Limmat * limmat, Variable ** a, Variable ** b)
-{
-  if (cmp (limmat, *a, *b) < 0)
-    swap (limmat, a, b);
-}
-
-/*------------------------------------------------------------------------*/
-
-inline static int
-partition (Limmat * limmat, Variable ** a, int l, int r)
-{
-  Variable *v;
-  int i, j;
-
-  i = l - 1;
-  j = r;
-  v = a[r];
-
-  for (;;)
-    {
-      while (cmp (limmat, a[++i], v) > 0)
-	;
-
-      while (cmp (limmat, v, a[--j]) > 0)
-	if (j == l)
-	  break;
-
-      if (i >= j)
-	break;
-
-      swap (limmat, a + i, a + j);
-    }
-
-  swap (limmat, a + i, a + r);
-
-  return i;
-}
-
-/*------------------------------------------------------------------------*/
-
-inline static void
-insertion (Limmat * limmat, Variable ** a, int l, int r)
-{
-  Variable *v;
-  int i, j;
-
-  for (i = r; i > l; i--)
-    cmpswap (limmat, a + i - 1, a + i);
-
-  for (i = l + 2; i <= r; i++)
-    {
-      j = i;
-      v = a[i];
-      while (cmp (limmat, v, a[j - 1]) > 0)
-	{
-	  a[j] = a[j - 1];
-	  j--;
-	}
-      a[j] = v;
-    }
-}
-
-/*------------------------------------------------------------------------*/
-
-#define ISORT_LIMIT 10
-
-/*------------------------------------------------------------------------*/
-
-inline static void
-quicksort (Limmat * limmat, Variable ** a, int l, int r)
-{
-  int i, m, l_to_push, r_to_push;
-  Stack *stack;
-
-#if 1
-  static int isort_limit = -1;
-  if (isort_limit < 0)
-    {
-      if (getenv ("ISORT"))
-	isort_limit = atoi (getenv ("ISORT"));
-      if (isort_limit < 0)
-	isort_limit = ISORT_LIMIT;
-    }
-#undef ISORT_LIMIT
-#define ISORT_LIMIT isort_limit
-#endif
-
-  assert (ISORT_LIMIT >= 3);
-  if (r - l <= ISORT_LIMIT)
-    return;
-
-  stack = &limmat->stack;
-  reset_Stack (limmat, stack, 0);
-
-  for (;;)
-    {
-#if 0
-      fprintf (stdout, "%d\n", r - l);
 #endif
-      m = (l + r) / 2;
-      swap (limmat, a + m, a + r - 1);
-      cmpswap (limmat, a + l, a + r - 1);
-      cmpswap (limmat, a + l, a + r);
-      cmpswap (limmat, a + r - 1, a + r);
-      i = partition (limmat, a, l + 1, r - 1);
-
-      if (i - l < r - i)
-	{
-	  l_to_push = i + 1;
-	  r_to_push = r;
-	  r = i - 1;
-	}
-      else
-	{
-	  l_to_push = l;
-	  r_to_push = i - 1;
-	  l = i + 1;
-	}
-
-      if (r - l > ISORT_LIMIT)
-	{
-	  assert (r_to_push - l_to_push > ISORT_LIMIT);
-	  push (limmat, stack, (void *) (PTR_SIZED_WORD) l_to_push);
-	  push (limmat, stack, (void *) (PTR_SIZED_WORD) r_to_push);
-	}
-      else if (r_to_push - l_to_push > ISORT_LIMIT)
-	{
-	  l = l_to_push;
-	  r = r_to_push;
-	}
-      else if (count_Stack (stack))
-	{
-	  r = (int) (PTR_SIZED_WORD) pop (stack);
-	  l = (int) (PTR_SIZED_WORD) pop (stack);
-	}
-      else
-	break;
-    }
-}
-
 /*------------------------------------------------------------------------*/
-/* This is the hyper sorting mechanism from the Sedgewick book.
+/* Restore the heap property bottom up after the scores of many literals
+ * have changed.
  */
 static void
-hypersort (Limmat * limmat, Variable ** a, int l, int r)
-{
-  quicksort (limmat, a, l, r);
-  insertion (limmat, a, l, r);
-}
-
-/*------------------------------------------------------------------------*/
-
-static void
-sort_order_aux (Limmat * limmat)
-{
-  Variable **base;
-  int end;
-
-  base = start_of_Stack (&limmat->order);
-  end = limmat->first_zero_pos - 1;
-  hypersort (limmat, base, 0, end);
-}
-
-/*------------------------------------------------------------------------*/
-
-static void
-adjust_search_interval (Limmat * limmat)
-{
-  int i, end, last_non_zero_pos, first_unassigned_pos;
-  Variable **variables, *v;
-
-  variables = start_of_Stack (&limmat->order);
-  end = limmat->first_zero_pos - 1;
-  last_non_zero_pos = -1;
-  first_unassigned_pos = end + 1;
-
-  for (i = 0; i <= end; i++)
-    {
-      v = variables[i];
-      if (first_unassigned_pos > end && !is_assigned (v))
-	first_unassigned_pos = i;
-      if (get_score (v))
-	last_non_zero_pos = i;
-      set_pos (v, i);
-    }
-
-  assert (last_non_zero_pos < limmat->first_zero_pos);
-  limmat->first_zero_pos = last_non_zero_pos + 1;
-  limmat->last_assigned_pos = first_unassigned_pos - 1;
-}
-
-/*------------------------------------------------------------------------*/
-#if !defined(NDEBUG) || defined(LIMMAT_WHITE)
-/*------------------------------------------------------------------------*/
-
-static int
-is_sorted (Limmat * limmat)
+heapify_order (Limmat * limmat)
 {
   Variable **order;
-  int i, end, res;
+  int i;
 
   order = start_of_Stack (&limmat->order);
-  end = limmat->first_zero_pos - 1;
-
-  for (i = 0, res = 1; res && i < end; i++)
-    res = (cmp (0, order[i], order[i + 1]) > 0);
 
-  return res;
-}
+  for (i = count_Stack (&limmat->order) / 2 - 1; i >= 0; i--)
+    down_order (limmat, order[i]);
 
-/*------------------------------------------------------------------------*/
-#endif
-/*------------------------------------------------------------------------*/
-/* Sort the array between from the start until 'limmat->first_zero_pos' (the
- * latter excluded).  We would like to start the sorting at
- * 'limmat->last_assigned_pos+1' but we have to take into account that
- * backtracking may actually unassign some variables with large positive
- * score.  Therefore those variables have to be sorted as well.
- */
-static void
-sort_order (Limmat * limmat)
-{
-  if (count_Stack (&limmat->order))
-    {
-      sort_order_aux (limmat);
-      adjust_search_interval (limmat);
-      assert (is_sorted (limmat));
-      invariant (limmat);
-    }
+  assert (is_heap (limmat));
+  invariant (limmat);
 }
 
 /*------------------------------------------------------------------------*/
-/* Initialize the score of a literal that is used for sorting by the number
- * of its occurences in clauses.  Also adjust 'first_zero_pos'.
+/* Initialize the score of a literal by the number of its occurences in
+ * clauses.
  */
 static void
 init_score (Limmat * limmat)
 {
-  int ref, i, last_non_zero_pos, pos;
   Variable *v, *end;
+  int ref, i;
+
+  limmat->score_increment = 1;
 
-  last_non_zero_pos = -1;
   forall_variables (limmat, v, end)
   {
     for (i = 0; i < 2; i++)
       {
 	ref = v->ref[i];
 	assert (ref >= 0);
-	v->saved[i] = ref;
 	v->score[i] = ref;
 	if (ref > limmat->current_max_score)
 	  {
@@ -4704,13 +5590,8 @@ init_score (Limmat * limmat)
 	    if (ref > limmat->max_score)
 	      limmat->max_score = ref;
 	  }
-
-	pos = v->pos[i];
-	if (ref > 0 && pos > last_non_zero_pos)
-	  last_non_zero_pos = pos;
       }
   }
-  limmat->first_zero_pos = last_non_zero_pos + 1;
 }
 
 /*------------------------------------------------------------------------*/
@@ -4719,81 +5600,60 @@ static void
 init_order (Limmat * limmat)
 {
   init_score (limmat);
-  sort_order (limmat);
+  heapify_order (limmat);
 }
 
 /*------------------------------------------------------------------------*/
-/* First divide the score of all variables by a certain amount and add the
- * delta of new references since the last rescore.  Then sort the variables
- * with respect to the new calculated score.
+/* Multiply the scores of all literals by 'factor'.  Since this does not
+ * change their relative order, the heap only has to be rebuilt if the
+ * factor is zero, which forgets all scores.
  */
 static void
-rescore (Limmat * limmat)
+rescale_scores (Limmat * limmat, double factor)
 {
-  int sign, ref, score, delta_ref, new_score, pos, end;
-  int max_new_score, last_non_zero_pos;
-  Variable *v, **variables;
+  Variable *v, *end;
+  int i;
+
+  forall_variables (limmat, v, end)
+    for (i = 0; i < 2; i++)
+      v->score[i] *= factor;
+
+  limmat->current_max_score *= factor;
+  limmat->max_score *= factor;
+
+  if (!factor)
+    heapify_order (limmat);
+}
+
+/*------------------------------------------------------------------------*/
+/* Instead of multiplying the scores of all literals with the score factor,
+ * the score increment for future learned clauses is divided by it.  Only
+ * if the increment becomes too large all scores are scaled down.
+ */
+#define MAX_SCORE_INCREMENT 1e100
 
+static void
+rescore (Limmat * limmat)
+{
 #ifdef LOG_RESCORE
   if (!limmat->dont_log)
     fprintf (LOGFILE (limmat), "RESCORE\t%.0f\n", limmat->rescore.finished);
 #endif
 
-  last_non_zero_pos = 0;
-  end = limmat->first_zero_pos - 1;
-  variables = start_of_Stack (&limmat->order);
-  assert (variables);
-
-  max_new_score = -1;
-
-  for (pos = 0; pos <= end; pos++)
+  if (limmat->score_factor <= 0)
     {
-      v = variables[pos];
-
-      assert (get_pos (v) == pos);
-      sign = is_signed (v);
-      if (sign)
-	v = not (v);
-
-      ref = v->ref[sign];
-      delta_ref = ref - v->saved[sign];
-      v->saved[sign] = ref;
-      score = v->score[sign];
-
-      if (score || delta_ref)
+      rescale_scores (limmat, 0);
+      limmat->score_increment = 1;
+    }
+  else
+    {
+      limmat->score_increment /= limmat->score_factor;
+      if (limmat->score_increment > MAX_SCORE_INCREMENT)
 	{
-	  assert (delta_ref >= 0);
-	  assert (score >= 0);
-
-	  new_score = score * (double) limmat->score_factor;
-
-	  if (delta_ref > 0)
-	    {
-	      if (limmat->stats)
-		limmat->stats->rescored_variables++;
-	      new_score += delta_ref;
-	    }
-
-	  if (new_score)
-	    {
-	      if (pos > last_non_zero_pos)
-		last_non_zero_pos = pos;
-	    }
-
-	  if (new_score > max_new_score)
-	    max_new_score = new_score;
-
-	  assert (new_score >= 0);
-	  v->score[sign] = new_score;
+	  rescale_scores (limmat, 1 / MAX_SCORE_INCREMENT);
+	  limmat->score_increment /= MAX_SCORE_INCREMENT;
 	}
     }
-
-  limmat->current_max_score = max_new_score;
-  if (max_new_score > limmat->max_score)
-    limmat->max_score = max_new_score;
-
-  limmat->first_zero_pos = last_non_zero_pos + 1;
-  sort_order (limmat);
 }
 
 /*------------------------------------------------------------------------*/
@@ -4812,16 +5672,69 @@ units2mark (Limmat * limmat)
   {
     clause = *p;
     assert (clause->size == 1);
-    assignment.literal = lit2var (clause2literals (limmat, clause)[0]);
+    assignment.literal = lit2var (limmat, clause2literals (limmat, clause)[0]);
     push_assignment (limmat, &assignment);
   }
 }
 
 /*------------------------------------------------------------------------*/
+/* Determine the number of decision levels, which would be decided again
+ * after a restart, since the decisions have a larger score than the next
+ * decision.  As in 'next_decision' literals of assigned variables are
+ * removed from the top of the heap.
+ */
+static int
+reusable_levels (Limmat * limmat)
+{
+  Variable *next, *decision;
+  Statistics *stats;
+  double score;
+  int res;
+
+  if (!limmat->reuse_trail)
+    return 0;
 
+  stats = limmat->stats;
+  next = 0;
+
+  while (count_Stack (&limmat->order) > 0)
+    {
+      next = *(Variable **) start_of_Stack (&limmat->order);
+      if (!is_assigned (next))
+	break;
+
+      (void) pop_order (limmat);
+      if (stats)
+	stats->searched++;
+
+      next = 0;
+    }
+
+  if (!next)
+    return 0;
+
+  score = get_score (next);
+
+  for (res = 0; res <= limmat->decision_level; res++)
+    {
+      decision = strip (limmat->control[res].decision);
+      if (decision->score[0] <= score && decision->score[1] <= score)
+	break;
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Restarts only unassign the variables above the top level.  The scores
+ * and saved phases are kept.  With trail reuse the decision levels, which
+ * would be decided again anyway, are kept as well.
+ */
 static void
 restart (Limmat * limmat)
 {
+  int reused;
+
   assert (limmat->decision_level >= 0);
 
 #ifdef LOG_RESTART
@@ -4829,84 +5742,453 @@ restart (Limmat * limmat)
     fprintf (LOGFILE (limmat), "RESTART\t%.0f\n", limmat->restart.finished);
 #endif
 
-  untrail (limmat, -1);
-  limmat->decision_level = -1;
-  init_order (limmat);
-  units2mark (limmat);
+  if (limmat->restart_policy != LIMMAT_GEOMETRIC_RESTARTS)
+    {
+      limmat->restart.finished++;
+      limmat->luby_index++;
+      schedule_restart (limmat);
+    }
+
+  reused = reusable_levels (limmat);
+  if (reused <= limmat->decision_level)
+    {
+      untrail (limmat, reused);
+      limmat->decision_level = reused - 1;
+    }
+
+  if (limmat->stats)
+    limmat->stats->reused += reused;
+
   invariant (limmat);
 }
 
 /*------------------------------------------------------------------------*/
-
+/* Learned clauses are ordered by decreasing glue and then by increasing
+ * activity.  The first half of the ordered candidates is removed.
+ */
 static int
-its_time_to_rescore (Limmat * limmat)
+cmp_reduce (const void *p, const void *q)
 {
-  int res;
+  Clause *c, *d;
 
-  dec_Counter (&limmat->rescore);
-  res = done_Counter (&limmat->rescore);
+  c = *(Clause **) p;
+  d = *(Clause **) q;
 
-  return res;
+  if (c->glue != d->glue)
+    return d->glue - c->glue;
+
+  if (c->activity != d->activity)
+    return c->activity - d->activity;
+
+  return c->id - d->id;
 }
 
 /*------------------------------------------------------------------------*/
-/* Search for a still unassigned decision literal and push it on the
- * assignment queue.
+/* Mark half of the learned clauses as garbage.  Reasons of the current
+ * assignments, binary clauses and clauses with a glue of at most
+ * 'REDUCEGLUE' are kept.  The result is the number of removed clauses.
  */
-static void
-decide (Limmat * limmat)
+static int
+mark_garbage (Limmat * limmat)
 {
-  Assignment assignment;
-  Variable *decision;
-  Statistics *stats;
-  int score;
+  Clause *clause, **p, **eoc, **candidates;
+  Variable **t, **eot;
+  int i, count;
 
-  if (its_time_to_rescore (limmat))
-    rescore (limmat);
-
-  decision = next_decision (limmat);
-  assert (decision);
+  forall_Stack (&limmat->trail, Variable *, t, eot)
+  {
+    clause = (*t)->reason;
+    if (clause)
+      clause->locked = 1;
+  }
 
-  stats = limmat->stats;
+  assert (!count_Stack (&limmat->stack));
 
-  if (stats)
-    {
-      stats->sum_assigned_in_decision += limmat->num_assigned;
-      score = get_score (decision);
-      assert (score == limmat->current_max_score);
-      stats->sum_score_in_decision += score;
-    }
+  forall_clauses (limmat, p, eoc)
+  {
+    clause = *p;
+    if (clause->learned && !clause->locked &&
+	clause->size > 2 && clause->glue > REDUCEGLUE)
+      push (limmat, &limmat->stack, clause);
+  }
 
-  limmat->num_decisions++;
-  push_frame (limmat, decision);
+  candidates = (Clause **) start_of_Stack (&limmat->stack);
+  count = count_Stack (&limmat->stack) / 2;
 
-  assignment.decision_level = limmat->decision_level;
-  assignment.literal = decision;
-  assignment.reason = 0;
-  push_assignment (limmat, &assignment);
+  if (count)
+    qsort (candidates, count_Stack (&limmat->stack),
+	   sizeof (Clause *), cmp_reduce);
 
-  if (limmat->log)
+  for (i = 0; i < count; i++)
     {
-      dec_Counter (&limmat->report);
-      if (done_Counter (&limmat->report))
-	one_line_stats (limmat);
-    }
+      clause = candidates[i];
+      clause->garbage = 1;
 
-#ifdef LOG_DECISION
-  if (!limmat->dont_log)
-    {
-      fprintf (LOGFILE (limmat),
-	       "DECIDE\t%d@%d\n", var2int (decision), limmat->decision_level);
+      limmat->num_clauses--;
+      limmat->num_literals -= clause->size;
+
+      if (limmat->stats)
+	{
+	  limmat->stats->removed_clauses++;
+	  limmat->stats->removed_literals += clause->size;
+	}
     }
-#endif
+
+  reset_Stack (limmat, &limmat->stack, 0);
+
+  forall_Stack (&limmat->trail, Variable *, t, eot)
+  {
+    clause = (*t)->reason;
+    if (clause)
+      clause->locked = 0;
+  }
+
+  return count;
 }
 
 /*------------------------------------------------------------------------*/
-#ifdef EXPENSIVE_CHECKS
-/*------------------------------------------------------------------------*/
-
+/* Remove the occurrences of garbage clauses from the watched lists.
+ */
 static void
-check_clause_is_implied (Limmat * limmat, Clause * new_clause)
+disconnect_garbage (Limmat * limmat)
+{
+  Occurence *w, *eow, *q;
+  Variable *v, *eov;
+  int i;
+
+  forall_variables (limmat, v, eov)
+  {
+    for (i = 0; i <= 1; i++)
+      {
+	q = (Occurence *) start_of_Stack (&v->watched[i]);
+
+	forall_watches (&v->watched[i], w, eow)
+	  if (!((Clause *) strip (*w))->garbage)
+	  {
+	    *q++ = w[0];
+	    *q++ = w[1];
+	  }
+
+	reset_Stack (limmat, &v->watched[i],
+		     q - (Occurence *) start_of_Stack (&v->watched[i]));
+      }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+/* During 'collect_garbage' the new address of a remaining clause is stored
+ * on the multipurpose stack at the position given by its new identifier.
+ * The sign of watched occurrences is kept.
+ */
+static Clause *
+forward (Limmat * limmat, Clause * clause)
+{
+  Clause *res;
+  int sign;
+
+  if ((sign = is_signed (clause)))
+    clause = not (clause);
+
+  assert (!clause->garbage);
+  res = ((Clause **) start_of_Stack (&limmat->stack))[clause->id];
+  if (sign)
+    res = not (res);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Move the remaining clauses to the front of the clause arena and release
+ * the memory of the garbage clauses.  The order of the clauses is kept,
+ * thus renumbering them preserves the relative order of their identifiers.
+ * All pointers to clauses are redirected before the clauses are moved.
+ */
+static void
+collect_garbage (Limmat * limmat)
+{
+  Clause *clause, **p, **eoc, **q, **eoq;
+  Variable *v, *eov, **t, **eot;
+  Occurence *w, *eow;
+  int i, bytes, count;
+  size_t delta;
+  char *dst;
+
+  assert (!count_Stack (&limmat->stack));
+
+  dst = start_of_Arena (&limmat->clause_arena);
+
+  forall_clauses (limmat, p, eoc)
+  {
+    clause = *p;
+    if (clause->garbage)
+      continue;
+
+    clause->id = count_Stack (&limmat->stack);
+    push (limmat, &limmat->stack, dst);
+    dst += align (bytes_Clause (clause->size), CLAUSE_ALIGNMENT);
+  }
+
+  forall_variables (limmat, v, eov)
+  {
+    for (i = 0; i <= 1; i++)
+      forall_watches (&v->watched[i], w, eow) *w = forward (limmat, *w);
+  }
+
+  forall_Stack (&limmat->trail, Variable *, t, eot)
+    if ((*t)->reason)
+    (*t)->reason = forward (limmat, (*t)->reason);
+
+  forall_Stack (&limmat->units, Clause *, q, eoq) *q = forward (limmat, *q);
+
+  /* Clauses only move down and a clause never overlaps the old place of
+   * the next clause.  Thus the headers of the clauses not moved yet are
+   * still intact.
+   */
+  forall_clauses (limmat, p, eoc)
+  {
+    clause = *p;
+    if (clause->garbage)
+      continue;
+
+    bytes = bytes_Clause (clause->size);
+    memmove (forward (limmat, clause), clause, bytes);
+  }
+
+  truncate_Arena (limmat, &limmat->clause_arena, dst);
+
+  count = count_Stack (&limmat->stack);
+  memcpy (start_of_Stack (&limmat->clauses),
+	  start_of_Stack (&limmat->stack), count * sizeof (Clause *));
+  reset_Stack (limmat, &limmat->clauses, count);
+  reset_Stack (limmat, &limmat->stack, 0);
+
+  forall_clauses (limmat, p, eoc) (*p)->activity /= 2;
+
+  shrink_Stack (limmat, &limmat->clauses);
+
+  shrink_Arena (limmat, &limmat->clause_arena, &delta);
+  if (delta)
+    fix_pointers_to_clauses (limmat, delta);
+}
+
+/*------------------------------------------------------------------------*/
+/* Keep the number of learned clauses in check by periodically removing the
+ * less useful half of them.  This is only called at decision points, where
+ * the assignment queue is empty, and all reasons of assigned variables are
+ * kept.  The collected bytes are the bytes of the clause arena reclaimed by
+ * compaction, whether or not the arena is shrunken afterwards.
+ */
+static void
+reduce (Limmat * limmat)
+{
+  size_t bytes;
+  int removed;
+
+  assert (!count_assignments (limmat));
+
+  bytes = data_bytes_Arena (&limmat->clause_arena);
+  removed = mark_garbage (limmat);
+
+  if (removed)
+    {
+      disconnect_garbage (limmat);
+      collect_garbage (limmat);
+    }
+
+  assert (bytes >= data_bytes_Arena (&limmat->clause_arena));
+
+  if (limmat->stats)
+    {
+      limmat->stats->reductions++;
+      limmat->stats->collected_bytes +=
+	bytes - data_bytes_Arena (&limmat->clause_arena);
+    }
+
+#ifdef LOG_REDUCE
+  if (!limmat->dont_log)
+    fprintf (LOGFILE (limmat), "REDUCE\t%d\n", removed);
+#endif
+
+  limmat->reduce_interval += REDUCEINC;
+  limmat->next_reduce = limmat->num_conflicts + limmat->reduce_interval;
+
+  invariant (limmat);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+its_time_to_reduce (Limmat * limmat)
+{
+  return limmat->reduce_init > 0 &&
+    limmat->num_conflicts >= limmat->next_reduce;
+}
+
+/*------------------------------------------------------------------------*/
+/* Saved phases easily get stuck in one part of the search space.  Thus
+ * they are reset after every few conflicts, alternating between the best
+ * phases and the original or inverted phases.  The original phase of a
+ * variable is its literal with the larger score.  The best phases are the
+ * signs of the variables on the largest trail since the last rephase.  The
+ * interval between rephases grows arithmetically by 'REPHASE' conflicts.
+ */
+static void
+rephase (Limmat * limmat)
+{
+  Variable *v, *end;
+  int kind;
+
+  if (limmat->rephases & 1)
+    kind = BEST_PHASES;
+  else if (limmat->rephases & 2)
+    kind = INVERTED_PHASES;
+  else
+    kind = ORIGINAL_PHASES;
+
+  forall_variables (limmat, v, end)
+  {
+    if (kind == ORIGINAL_PHASES)
+      v->phased = 0;
+    else if (kind == INVERTED_PHASES)
+      {
+	v->phase = (v->score[0] >= v->score[1]);
+	v->phased = 1;
+      }
+    else if (v->bested)
+      {
+	v->phase = v->best;
+	v->phased = 1;
+      }
+
+    v->bested = 0;
+  }
+
+  if (limmat->stats)
+    limmat->stats->rephased[kind]++;
+
+#ifdef LOG_REPHASE
+  if (!limmat->dont_log)
+    fprintf (LOGFILE (limmat), "REPHASE\t%c\n", "OIB"[kind]);
+#endif
+
+  limmat->best_assigned = 0;
+  limmat->rephases++;
+  limmat->next_rephase = limmat->num_conflicts +
+    limmat->rephase_init * (double) (limmat->rephases + 1);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+its_time_to_rephase (Limmat * limmat)
+{
+  return limmat->save_phases && limmat->rephase_init > 0 &&
+    limmat->num_conflicts >= limmat->next_rephase;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+its_time_to_rescore (Limmat * limmat)
+{
+  int res;
+
+  dec_Counter (&limmat->rescore);
+  res = done_Counter (&limmat->rescore);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Find the first assumption that is not satisfied yet.  The result is
+ * 'TRUE' if all assumptions are satisfied and 'FALSE' if one of them is
+ * falsified already.  Since assumptions are always decided first, in the
+ * last case the assumptions are inconsistent with the clauses.
+ */
+static Variable *
+next_assumption (Limmat * limmat)
+{
+  Variable *res, *tmp;
+  void **p, **eoa;
+  int literal;
+
+  forall_Stack (&limmat->assumptions, void *, p, eoa)
+  {
+    literal = (int) (PTR_SIZED_WORD) * p;
+    res = find (limmat, literal);
+    tmp = deref (res);
+
+    if (tmp == FALSE)
+      return FALSE;
+
+    if (tmp != TRUE)
+      return res;
+  }
+
+  return TRUE;
+}
+
+/*------------------------------------------------------------------------*/
+/* Search for a still unassigned decision literal and push it on the
+ * assignment queue.  An unsatisfied assumption, as returned by
+ * 'next_assumption', is decided first.
+ */
+static void
+decide (Limmat * limmat, Variable * assumption)
+{
+  Assignment assignment;
+  Variable *decision;
+  Statistics *stats;
+  double score;
+
+  if (its_time_to_rescore (limmat))
+    rescore (limmat);
+
+  if (assumption != TRUE)
+    decision = assumption;
+  else
+    decision = next_decision (limmat);
+  assert (decision);
+
+  stats = limmat->stats;
+
+  if (stats && assumption == TRUE)
+    {
+      stats->sum_assigned_in_decision += limmat->num_assigned;
+      score = limmat->current_max_score;
+      stats->sum_score_in_decision += score;
+    }
+
+  limmat->num_decisions++;
+  push_frame (limmat, decision);
+
+  assignment.decision_level = limmat->decision_level;
+  assignment.literal = decision;
+  assignment.reason = 0;
+  push_assignment (limmat, &assignment);
+
+  if (limmat->log)
+    {
+      dec_Counter (&limmat->report);
+      if (done_Counter (&limmat->report))
+	one_line_stats (limmat);
+    }
+
+#ifdef LOG_DECISION
+  if (!limmat->dont_log)
+    {
+      fprintf (LOGFILE (limmat),
+	       "DECIDE\t%d@%d\n", var2int (decision), limmat->decision_level);
+    }
+#endif
+}
+
+/*------------------------------------------------------------------------*/
+#ifdef EXPENSIVE_CHECKS
+/*------------------------------------------------------------------------*/
+
+static void
+check_clause_is_implied (Limmat * limmat, Clause * new_clause)
 {
 #if 0
 #warning "check_clause_is_implied disabled"
@@ -4943,7 +6225,7 @@ check_clause_is_implied (Limmat * limmat, Clause * new_clause)
 	for (i = 0; i < n; i++)
 	  {
 	    id =
-	      var2int (not (lit2var (clause2literals (limmat, clause)[i])));
+	      var2int (not (lit2var (limmat, clause2literals (limmat, clause)[i])));
 	    v = find (tmp, id);
 	    add_clause (tmp, &v, 1, 0);
 	  }
@@ -4954,7 +6236,7 @@ check_clause_is_implied (Limmat * limmat, Clause * new_clause)
 
 	for (i = 0; i < n; i++)
 	  {
-	    id = var2int (lit2var (clause2literals (limmat, clause)[i]));
+	    id = var2int (lit2var (limmat, clause2literals (limmat, clause)[i]));
 	    v = find (tmp, id);
 	    push (tmp, &tmp->stack, v);
 	  }
@@ -4972,6 +6254,86 @@ check_clause_is_implied (Limmat * limmat, Clause * new_clause)
 
 /*------------------------------------------------------------------------*/
 #endif
+/*------------------------------------------------------------------------*/
+/* The glue of a learned clause is the number of different decision levels
+ * of its literals.  Clauses with a small glue connect only a few decisions
+ * and are kept in 'reduce'.  The frames of the decision levels are marked
+ * with a new stamp, which avoids resetting the marks.
+ */
+static int
+glue (Limmat * limmat, Variable ** literals, int count)
+{
+  int i, level, res;
+  Frame *frame;
+
+  res = 0;
+  limmat->stamp++;
+
+  for (i = 0; i < count; i++)
+    {
+      level = ((Variable *) strip (literals[i]))->decision_level;
+      assert (level >= 0);
+      assert (level <= limmat->decision_level);
+
+      frame = limmat->control + level;
+      if (frame->stamp != limmat->stamp)
+	{
+	  frame->stamp = limmat->stamp;
+	  res++;
+	}
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Update the moving averages of the glue of learned clauses and of the size
+ * of the trail at conflicts for glucose restarts.  The averages start as
+ * plain averages until the number of samples reaches the window size given
+ * by the inverse of the smoothing factor.  A pending restart is blocked if
+ * the trail is much larger than on average, since the solver might be
+ * close to a satisfying assignment.
+ */
+#define FAST_GLUE_ALPHA 3e-2
+#define SLOW_GLUE_ALPHA 1e-4
+#define TRAIL_ALPHA 2e-4
+
+static void
+update_average (double *average, double value, double alpha, double samples)
+{
+  if (alpha < 1 / samples)
+    alpha = 1 / samples;
+
+  *average += alpha * (value - *average);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+update_averages (Limmat * limmat, int glue)
+{
+  if (limmat->restart_policy != LIMMAT_GLUCOSE_RESTARTS)
+    return;
+
+  limmat->averaged++;
+
+  if (limmat->num_conflicts >= MIN_BLOCK_CONFLICTS &&
+      limmat->num_conflicts >= limmat->next_restart &&
+      limmat->num_assigned > limmat->glucose_block * limmat->trail_average)
+    {
+      schedule_restart (limmat);
+      if (limmat->stats)
+	limmat->stats->blocked_restarts++;
+    }
+
+  update_average (&limmat->trail_average, limmat->num_assigned,
+		  TRAIL_ALPHA, limmat->averaged);
+  update_average (&limmat->fast_glue, glue, FAST_GLUE_ALPHA,
+		  limmat->averaged);
+  update_average (&limmat->slow_glue, glue, SLOW_GLUE_ALPHA,
+		  limmat->averaged);
+}
+
 /*------------------------------------------------------------------------*/
 /* Add all literals on the 'literals' stack as a clause to the clause data
  * base and generate a conflict driven assignment.
@@ -4994,6 +6356,8 @@ add_literals (Limmat * limmat, Assignment * assignment)
   literals = (Variable **) start_of_Stack (&limmat->clause);
   clause = add_clause (limmat, literals, count, assignment);
   clause->learned = 1;
+  clause->glue = glue (limmat, literals, count);
+  update_averages (limmat, clause->glue);
   reset_Stack (limmat, &limmat->clause, 0);
 
 #ifdef LOG_LEARNED
@@ -5046,11 +6410,15 @@ push_literal (Limmat * limmat, Variable * v)
 inline static void
 expand_open_paths (Limmat * limmat, Clause * clause, int *paths)
 {
-  Variable *v, **p, **eol;
+  int *p, *eol;
+  Variable *v;
+
+  if (clause->learned)
+    clause->activity++;
 
   forall_literals (limmat, clause, p, eol)
   {
-    v = strip (lit2var (*p));
+    v = strip (lit2var (limmat, *p));
 
     if (v->decision_level >= 0 && !v->mark)
       {
@@ -5088,11 +6456,12 @@ expand_open_paths (Limmat * limmat, Clause * clause, int *paths)
 static void
 unmark_clause_after_conflict_generation (Limmat * limmat, Clause * clause)
 {
-  Variable **p, **eol, *v;
+  int *p, *eol;
+  Variable *v;
 
   forall_literals (limmat, clause, p, eol)
   {
-    v = strip (lit2var (*p));
+    v = strip (lit2var (limmat, *p));
     assert (v->decision_level <= limmat->decision_level);
     if (v->decision_level >= 0)
       if (v->decision_level < limmat->decision_level)
@@ -5122,24 +6491,165 @@ unmark_after_conflict_generation (Limmat * limmat, Variable * v)
 }
 
 /*------------------------------------------------------------------------*/
-/* A unique implication point (uip) is an assigned variable in the current
- * decision level that occurs on all paths back from the conflict ignoring
- * edges leading to variables with lower decision level.  The decision
- * variable of the current decision level acts as a sentinel to this search.
- * The reverse order of the assigned variables on the trail is a topological
- * order of the dependency graph.  Thus we do not need a general graph
- * algorithm to decompose a graph in its biconnected components.
+/* A literal of the conflict clause is redundant if it is implied by the
+ * other literals of the conflict clause.  This is checked by a depth first
+ * search backward through the reasons of the assignments, which fails as
+ * soon as a decision or a variable on a decision level not occurring in
+ * the conflict clause is reached.  Frames of these decision levels carry
+ * the current stamp.  Marked variables are either in the conflict clause
+ * or already known to be implied by it.  The latter are collected on the
+ * 'redundant' stack for unmarking them later.
  */
-static void
-generate_conflict_clause (Limmat * limmat, Clause * conflict)
+static int
+is_redundant (Limmat * limmat, Variable * v)
 {
-  Variable **assigned, **last_assigned, **first_assigned, **p, *v;
+  Variable *u, *w;
   Clause *reason;
-  Frame *frame;
-  int paths;
+  int *p, *eol;
+  int top;
 
-  assert (!count_Stack (&limmat->clause));
-  assert (limmat->decision_level >= 0);
+  assert (v->mark);
+  assert (v->decision_level >= 0);
+  assert (v->decision_level < limmat->decision_level);
+
+  if (!v->reason)
+    return 0;
+
+  top = count_Stack (&limmat->redundant);
+  assert (!count_Stack (&limmat->stack));
+  push (limmat, &limmat->stack, v);
+
+  while (count_Stack (&limmat->stack))
+    {
+      u = (Variable *) pop (&limmat->stack);
+      reason = u->reason;
+      assert (reason);
+
+      forall_literals (limmat, reason, p, eol)
+      {
+	w = strip (lit2var (limmat, *p));
+	if (w == u || w->mark || w->decision_level < 0)
+	  continue;
+
+	assert (w->decision_level <= u->decision_level);
+
+	if (!w->reason ||
+	    limmat->control[w->decision_level].stamp != limmat->stamp)
+	  {
+	    while (count_Stack (&limmat->redundant) > top)
+	      {
+		w = (Variable *) pop (&limmat->redundant);
+		w->mark = 0;
+	      }
+
+	    reset_Stack (limmat, &limmat->stack, 0);
+
+	    return 0;
+	  }
+
+	w->mark = 1;
+	push (limmat, &limmat->stack, w);
+	push (limmat, &limmat->redundant, w);
+      }
+    }
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* First all redundant literals are removed from the conflict clause, see
+ * 'is_redundant'.  As a post-pass a literal is removed if it is implied by
+ * the uip through a binary clause.  This is indicated by resetting its
+ * 'mark' bit.  The uip is kept.  The remaining literals stay marked, such
+ * that the marks can be reset as usual afterwards.
+ */
+static void
+minimize_conflict_clause (Limmat * limmat, Variable * uip)
+{
+  Variable **literals, *u, *v;
+  Occurence *w, *eow;
+  Statistics *stats;
+  int i, j, count, blocker;
+
+  stats = limmat->stats;
+  literals = (Variable **) start_of_Stack (&limmat->clause);
+  count = count_Stack (&limmat->clause);
+
+  limmat->stamp++;
+  for (i = 0; i < count; i++)
+    {
+      v = strip (literals[i]);
+      limmat->control[v->decision_level].stamp = limmat->stamp;
+    }
+
+  for (i = j = 0; i < count; i++)
+    {
+      v = strip (literals[i]);
+      if (v->decision_level < limmat->decision_level &&
+	  is_redundant (limmat, v))
+	{
+	  if (stats)
+	    stats->minimized_literals++;
+	}
+      else
+	literals[j++] = literals[i];
+    }
+
+  count = j;
+
+  while (count_Stack (&limmat->redundant))
+    {
+      v = (Variable *) pop (&limmat->redundant);
+      v->mark = 0;
+    }
+
+  u = (uip->assignment == TRUE) ? uip : not (uip);
+
+  forall_watches (var2stack (not (u)), w, eow)
+  {
+    if (get_watch_kind (w) != BINARY_WATCH)
+      continue;
+
+    blocker = get_blocker (w);
+    if (lit2val (limmat, blocker) > 0)
+      {
+	v = strip (lit2var (limmat, blocker));
+	if (v->decision_level < limmat->decision_level)
+	  v->mark = 0;
+      }
+  }
+
+  for (i = j = 0; i < count; i++)
+    {
+      v = strip (literals[i]);
+      if (v->mark || v == uip)
+	literals[j++] = literals[i];
+      else if (stats)
+	stats->strengthened_literals++;
+    }
+
+  reset_Stack (limmat, &limmat->clause, j);
+}
+
+/*------------------------------------------------------------------------*/
+/* A unique implication point (uip) is an assigned variable in the current
+ * decision level that occurs on all paths back from the conflict ignoring
+ * edges leading to variables with lower decision level.  The decision
+ * variable of the current decision level acts as a sentinel to this search.
+ * The reverse order of the assigned variables on the trail is a topological
+ * order of the dependency graph.  Thus we do not need a general graph
+ * algorithm to decompose a graph in its biconnected components.
+ */
+static void
+generate_conflict_clause (Limmat * limmat, Clause * conflict)
+{
+  Variable **assigned, **last_assigned, **first_assigned, **p, *v;
+  Clause *reason;
+  Frame *frame;
+  int paths;
+
+  assert (!count_Stack (&limmat->clause));
+  assert (limmat->decision_level >= 0);
 
   frame = limmat->control + limmat->decision_level;
   assigned = (Variable **) start_of_Stack (&limmat->trail);
@@ -5186,6 +6696,9 @@ generate_conflict_clause (Limmat * limmat, Clause * conflict)
 
   assert (v);
 
+  if (limmat->minimize)
+    minimize_conflict_clause (limmat, v);
+
   /* Reset the mark bit of all traversed variables.
    */
   while (++p <= last_assigned)
@@ -5238,6 +6751,31 @@ analyze (Limmat * limmat, Clause * conflict, Assignment * assignment)
     }
 }
 
+/*------------------------------------------------------------------------*/
+/* Remember the signs of the assigned variables as best phases, if the
+ * trail is larger than all trails since the last rephase.
+ */
+static void
+save_best_phases (Limmat * limmat)
+{
+  Variable **p, **eot, *v;
+
+  if (!limmat->save_phases || limmat->rephase_init <= 0)
+    return;
+
+  if (limmat->num_assigned <= limmat->best_assigned)
+    return;
+
+  limmat->best_assigned = limmat->num_assigned;
+
+  forall_Stack (&limmat->trail, Variable *, p, eot)
+  {
+    v = *p;
+    v->best = (v->assignment == FALSE);
+    v->bested = 1;
+  }
+}
+
 /*------------------------------------------------------------------------*/
 
 static int
@@ -5253,6 +6791,7 @@ backtrack (Limmat * limmat, Clause * conflict)
 
   reset_assignments (limmat);
   analyze (limmat, conflict, &assignment);
+  save_best_phases (limmat);
   res = (assignment.literal != FALSE);
   untrail (limmat, assignment.decision_level + 1);
   delta = limmat->decision_level - assignment.decision_level;
@@ -5305,7 +6844,7 @@ max_decision_level_clause (Limmat * limmat, Clause * clause)
 
   for (res = -1, i = 0; i < clause->size; i++)
     {
-      literal = strip (lit2var (clause2literals (limmat, clause)[i]));
+      literal = strip (lit2var (limmat, clause2literals (limmat, clause)[i]));
       if (literal->decision_level > res)
 	res = literal->decision_level;
     }
@@ -5350,14 +6889,16 @@ next_pos (int prev,
  */
 inline static Clause *
 propagate_clause (Limmat * limmat,
-		  Occurence signed_clause, int decision_level, int *remove)
+		  Occurence * watch, int decision_level, int *remove)
 {
   int sign, start, head, tail, i, num_literals, turned, direction;
-  Variable *tmp, **literals, *dereferenced_tail;
-  Variable *literal, *tail_literal;
+  int *literals, val, tail_val;
+  Occurence signed_clause;
   Clause *conflict, *clause;
   Assignment new_assignment;
 
+  signed_clause = watch[0];
+
   if (limmat->stats)
     limmat->stats->propagations++;
 
@@ -5388,14 +6929,12 @@ propagate_clause (Limmat * limmat,
 
       literals = clause2literals (limmat, clause);
 #ifndef LOOK_AT_OTHER_WATCHED_LITERAL
-      tail_literal = 0;
-      dereferenced_tail = FALSE;
+      tail_val = -1;
 #else
-      tail_literal = lit2var (literals[tail]);
-      dereferenced_tail = deref (tail_literal);
-      if (dereferenced_tail == FALSE)
-	conflict = clause;
-      else if (dereferenced_tail != TRUE)
+      tail_val = lit2val (limmat, literals[tail]);
+      if (tail_val > 0)
+	set_blocker (watch, literals[tail]);
+      else
 #endif
 	{
 	  head = clause->watched[sign];
@@ -5403,7 +6942,7 @@ propagate_clause (Limmat * limmat,
 
 	  assert (num_literals >= 2);
 	  assert (head >= 0);
-	  assert (deref (lit2var (literals[head])) == FALSE);
+	  assert (lit2val (limmat, literals[head]) < 0);
 
 	  /* Now try to find an unassigned literal among the literals of the
 	   * clause.  Stop as soon a literal assigned to 'TRUE' is found or
@@ -5419,9 +6958,9 @@ propagate_clause (Limmat * limmat,
 	  start = head;
 	  i = start;
 
-	  tmp = FALSE;
+	  val = -1;
 
-	  while (tmp == FALSE && turned < 2)
+	  while (val < 0 && turned < 2)
 	    {
 #ifdef LOOK_AT_OTHER_WATCHED_LITERAL
 	      /* Just skip the 'tail', since we already checked it.  Also
@@ -5438,31 +6977,38 @@ propagate_clause (Limmat * limmat,
 #ifndef LOOK_AT_OTHER_WATCHED_LITERAL
 		    if (i == tail)
 		      {
-			tail_literal = lit2var (literals[i]);
-			dereferenced_tail = deref (tail_literal);
-			if (dereferenced_tail == TRUE)
+			tail_val = lit2val (limmat, literals[i]);
+			if (tail_val > 0)
 			  break;
 		      }
 		    else
 #endif
-		      {
-			literal = lit2var (literals[i]);
-			tmp = deref (literal);
-		      }
+		      val = lit2val (limmat, literals[i]);
 		  }
 
-	      if (tmp == FALSE)
+	      if (val < 0)
 		i = next_pos (i, &direction, start, num_literals, &turned);
 	    }
 
 #ifndef LOOK_AT_OTHER_WATCHED_LITERAL
-	  if (tmp == FALSE && dereferenced_tail == FALSE)
+	  if (val < 0 && tail_val < 0)
 	    conflict = clause;
-	  else if (dereferenced_tail == TRUE)
+	  else if (tail_val > 0)
 	    {
-	      /* nothing to be done */
+	      /* The clause stays watched here but is satisfied by the tail
+	       * literal, which is a good blocking literal.
+	       */
+	      set_blocker (watch, literals[tail]);
 	    }
 	  else
+#else
+	  /* The tail literal may be false without the clause being empty,
+	   * if the clause was skipped earlier because of a true blocking
+	   * literal.  Then only the traversal can detect a conflict.
+	   */
+	  if (turned >= 2 && tail_val < 0)
+	    conflict = clause;
+	  else
 #endif
 
 	  if (turned >= 2)
@@ -5473,8 +7019,7 @@ propagate_clause (Limmat * limmat,
 	       * while traversing the clause.  Keep this occurence of the
 	       * literal as watched.
 	       */
-	      assert (tail_literal);
-	      new_assignment.literal = tail_literal;
+	      new_assignment.literal = lit2var (limmat, literals[tail]);
 	      new_assignment.decision_level = decision_level;
 	      new_assignment.reason = clause;
 	      push_assignment (limmat, &new_assignment);
@@ -5502,13 +7047,96 @@ propagate_clause (Limmat * limmat,
   return conflict;
 }
 
+/*------------------------------------------------------------------------*/
+/* The watch of a binary clause contains the other literal as blocking
+ * literal, which is either false, which yields a conflict, or unassigned,
+ * which yields a new assignment.  The clause itself is not accessed.
+ */
+inline static Clause *
+propagate_binary (Limmat * limmat,
+		  Occurence * watch, int other, int val, int decision_level)
+{
+  Assignment new_assignment;
+  Clause *clause;
+
+  assert (val <= 0);
+
+  if (limmat->stats)
+    limmat->stats->propagations++;
+
+  clause = strip (watch[0]);
+  assert (clause->size == 2);
+
+  if (val < 0)
+    return clause;
+
+  new_assignment.literal = lit2var (limmat, other);
+  new_assignment.decision_level = decision_level;
+  new_assignment.reason = clause;
+  push_assignment (limmat, &new_assignment);
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+/* The literal 'lit' of a ternary clause just became false.  Since ternary
+ * clauses are watched on all literals, it is enough to look at the other
+ * two literals.
+ */
+inline static Clause *
+propagate_ternary (Limmat * limmat,
+		   Occurence * watch, int lit, int decision_level)
+{
+  int *literals, other[2], val[2], i, j;
+  Assignment new_assignment;
+  Clause *clause;
+
+  if (limmat->stats)
+    {
+      limmat->stats->propagations++;
+      limmat->stats->visits += 2;
+    }
+
+  clause = strip (watch[0]);
+  assert (clause->size == 3);
+  literals = clause2literals (limmat, clause);
+
+  for (i = j = 0; i < 3; i++)
+    if (literals[i] != lit)
+      other[j++] = literals[i];
+
+  assert (j == 2);
+
+  for (i = 0; i < 2; i++)
+    {
+      if ((val[i] = lit2val (limmat, other[i])) > 0)
+	{
+	  set_blocker (watch, other[i]);
+	  return 0;
+	}
+    }
+
+  if (val[0] < 0 && val[1] < 0)
+    return clause;
+
+  if (val[0] < 0 || val[1] < 0)
+    {
+      new_assignment.literal = lit2var (limmat, other[val[0] < 0]);
+      new_assignment.decision_level = decision_level;
+      new_assignment.reason = clause;
+      push_assignment (limmat, &new_assignment);
+    }
+
+  return 0;
+}
+
 /*------------------------------------------------------------------------*/
 
 inline static Clause *
 propagate_assignment (Limmat * limmat, Assignment * assignment)
 {
+  int i, count, remove, lit, blocker, val, kind;
   Occurence *occurrences;
-  int i, count, remove;
   Clause *conflict;
   Stack *stack;
 
@@ -5518,24 +7146,58 @@ propagate_assignment (Limmat * limmat, Assignment * assignment)
 	    <= assignment->decision_level);
 #endif
 
+#ifndef TRAIL_PROPAGATION
   /* First actually assign the literal.
    */
   assign (limmat, assignment);
+#endif
 
   /* Traverse all occurrences that contain a watched negated literal of the
-   * assignment, as long no conflict has been found.
+   * assignment, as long no conflict has been found.  A clause with a true
+   * blocking literal is satisfied and does not have to be visited.  This
+   * relies on the blocking literal being assigned at a decision level not
+   * larger than the current one, which holds since all queued assignments
+   * belong to the current decision level.
    */
+  assert (assignment->decision_level == limmat->decision_level);
+
   stack = var2stack (not (assignment->literal));
   occurrences = start_of_Stack (stack);
   count = count_Stack (stack);
+  lit = var2lit (not (assignment->literal));
   conflict = 0;
   i = 0;
 
   while (!conflict && i < count)
     {
+      blocker = get_blocker (occurrences + i);
+      if ((val = lit2val (limmat, blocker)) > 0)
+	{
+	  if (limmat->stats)
+	    limmat->stats->blocked++;
+
+	  i += 2;
+	  continue;
+	}
+
+      /* Watches of binary and ternary clauses never move.
+       */
+      kind = get_watch_kind (occurrences + i);
+      if (kind != LONG_WATCH)
+	{
+	  if (kind == BINARY_WATCH)
+	    conflict = propagate_binary (limmat, occurrences + i, blocker,
+					 val, assignment->decision_level);
+	  else
+	    conflict = propagate_ternary (limmat, occurrences + i, lit,
+					  assignment->decision_level);
+	  i += 2;
+	  continue;
+	}
+
       conflict =
-	propagate_clause (limmat, occurrences[i], assignment->decision_level,
-			  &remove);
+	propagate_clause (limmat, occurrences + i,
+			  assignment->decision_level, &remove);
 
       /* To remove the occurence from the stack we just overwrite it with
        * the last entry in the stack and pop the last Element of the stack.
@@ -5546,11 +7208,14 @@ propagate_assignment (Limmat * limmat, Assignment * assignment)
 	{
 	  if (remove)
 	    {
-	      if (--count > 0)
-		occurrences[i] = occurrences[count];
+	      if ((count -= 2) > 0)
+		{
+		  occurrences[i] = occurrences[count];
+		  occurrences[i + 1] = occurrences[count + 1];
+		}
 	    }
 	  else
-	    i++;
+	    i += 2;
 	}
     }
 
@@ -5566,12 +7231,31 @@ propagate_assignment (Limmat * limmat, Assignment * assignment)
 static Clause *
 propagate (Limmat * limmat)
 {
+#ifdef TRAIL_PROPAGATION
+  Variable *v;
+#else
   Variable *literal, *tmp;
+#endif
   Assignment assignment;
   Clause *conflict;
 
   conflict = 0;
 
+#ifdef TRAIL_PROPAGATION
+  while (!conflict && count_assignments (limmat) > 0)
+    {
+      /* The next assignment to be propagated is already on the trail.
+       */
+      v = ((Variable **) start_of_Stack (&limmat->trail))
+	[limmat->propagated++];
+
+      assignment.literal = (v->assignment == TRUE) ? v : not (v);
+      assignment.decision_level = v->decision_level;
+      assignment.reason = v->reason;
+
+      conflict = propagate_assignment (limmat, &assignment);
+    }
+#else
   while (!conflict && count_assignments (limmat) > 0)
     {
       /* Pop next assignment from mark stack.  Each assignment is made of
@@ -5597,6 +7281,7 @@ propagate (Limmat * limmat)
       else
 	conflict = propagate_assignment (limmat, &assignment);
     }
+#endif
 
 #ifdef LOG_CONFLICT
   if (conflict && !limmat->dont_log)
@@ -5617,9 +7302,9 @@ propagate (Limmat * limmat)
 static int
 all_clauses_satisfied (Limmat * limmat)
 {
-  Variable **q, **eol;
   Clause **p, **eoc;
   int res, found;
+  int *q, *eol;
 
   res = !limmat->contains_empty_clause;
 
@@ -5628,7 +7313,7 @@ all_clauses_satisfied (Limmat * limmat)
     found = 0;
 
     forall_literals (limmat, *p, q, eol)
-      if ((found = (deref (lit2var (*q)) == TRUE)))
+      if ((found = (lit2val (limmat, *q) > 0)))
       break;
 
     if (!(res = found))
@@ -5640,30 +7325,81 @@ all_clauses_satisfied (Limmat * limmat)
 
 /*------------------------------------------------------------------------*/
 
+/* Geometric restarts are counted in decisions.  Luby restarts happen after
+ * the scheduled number of conflicts.  Glucose restarts additionally require
+ * the fast moving average of the glue of learned clauses to exceed the slow
+ * one by the glucose margin.
+ */
 static int
 its_time_to_restart (Limmat * limmat)
 {
   int res;
 
-  if (limmat->decision_level >= 0)
+  if (limmat->decision_level < 0)
+    res = 0;
+  else if (limmat->restart_policy == LIMMAT_GEOMETRIC_RESTARTS)
     {
       dec_Counter (&limmat->restart);
       res = done_Counter (&limmat->restart);
     }
-  else
+  else if (limmat->num_conflicts < limmat->next_restart)
     res = 0;
+  else if (limmat->restart_policy == LIMMAT_LUBY_RESTARTS)
+    res = (limmat->luby_unit > 0);
+  else
+    res = (limmat->fast_glue > limmat->glucose_margin * limmat->slow_glue);
 
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+/* Reading the time is too expensive to be done for every decision.
+ */
+#define TIME_LIMIT_CHECK_INTERVAL 100
+
+static int
+time_limit_exceeded (Limmat * limmat)
+{
+  if (limmat->time_limit < 0)
+    return 0;
+
+  if (limmat->time_limit_check-- > 0)
+    return 0;
+
+  limmat->time_limit_check = TIME_LIMIT_CHECK_INTERVAL;
+
+  return get_wall_time () - limmat->time_limit_start > limmat->time_limit;
+}
+
+/*------------------------------------------------------------------------*/
+/* The conflict and memory limits are cheap to check and are checked before
+ * every decision.
+ */
+static int
+limit_exceeded (Limmat * limmat)
+{
+  if (limmat->conflict_limit >= 0 &&
+      limmat->num_conflicts - limmat->conflicts_before >=
+      limmat->conflict_limit)
+    return 1;
+
+  if (limmat->memory_limit && limmat->bytes > limmat->memory_limit)
+    return 1;
+
+  return time_limit_exceeded (limmat);
+}
+
 /*------------------------------------------------------------------------*/
 
 static int
 sat (Limmat * limmat, int max_decisions)
 {
   int res, num_decisions;
+  Variable *assumption;
   Clause *conflict;
 
+  reset_search (limmat);
+
   if (limmat->contains_empty_clause)
     res = 0;
   else
@@ -5682,7 +7418,10 @@ sat (Limmat * limmat, int max_decisions)
 	      if (conflict && !backtrack (limmat, conflict))
 		res = 0;
 	    }
-	  else if (limmat->num_assigned < limmat->num_variables)
+	  else if ((assumption = next_assumption (limmat)) == FALSE)
+	    res = 0;
+	  else if (assumption != TRUE ||
+		   limmat->num_assigned < limmat->num_variables)
 	    {
 	      if (max_decisions >= 0)
 		{
@@ -5692,10 +7431,21 @@ sat (Limmat * limmat, int max_decisions)
 		  num_decisions++;
 		}
 
+	      if (limit_exceeded (limmat))
+		break;
+
 	      if (its_time_to_restart (limmat))
 		restart (limmat);
 	      else
-		decide (limmat);
+		{
+		  if (its_time_to_reduce (limmat))
+		    reduce (limmat);
+
+		  if (its_time_to_rephase (limmat))
+		    rephase (limmat);
+
+		  decide (limmat, assumption);
+		}
 	    }
 	  else
 	    {
@@ -5730,7 +7480,12 @@ sat_Limmat (Limmat * limmat, int max_decisions)
   int res;
 
   start_timer (&limmat->timer);
+  if (limmat->time_limit >= 0)
+    limmat->time_limit_start = get_wall_time ();
+  limmat->time_limit_check = 0;
+  limmat->conflicts_before = limmat->num_conflicts;
   res = sat (limmat, max_decisions);
+  reset_Stack (limmat, &limmat->assumptions, 0);
   limmat->time += stop_timer (limmat->timer);
 
   return res;
@@ -5738,6 +7493,56 @@ sat_Limmat (Limmat * limmat, int max_decisions)
 
 /*------------------------------------------------------------------------*/
 
+void
+set_time_limit_Limmat (Limmat * limmat, double seconds)
+{
+  limmat->time_limit = seconds;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+set_conflict_limit_Limmat (Limmat * limmat, int conflicts)
+{
+  limmat->conflict_limit = conflicts;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+set_memory_limit_Limmat (Limmat * limmat, size_t bytes)
+{
+  limmat->memory_limit = bytes;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+set_restart_policy_Limmat (Limmat * limmat, int policy)
+{
+  if (policy != LIMMAT_GEOMETRIC_RESTARTS &&
+      policy != LIMMAT_LUBY_RESTARTS && policy != LIMMAT_GLUCOSE_RESTARTS)
+    return;
+
+  limmat->restart_policy = policy;
+  limmat->luby_index = 0;
+  schedule_restart (limmat);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+assume_Limmat (Limmat * limmat, int literal)
+{
+  assert (literal);
+
+  reset_search (limmat);
+  (void) find (limmat, literal);
+  push (limmat, &limmat->assumptions, (void *) (PTR_SIZED_WORD) literal);
+}
+
+/*------------------------------------------------------------------------*/
+
 const int *
 assignment_Limmat (Limmat * limmat)
 {
@@ -6648,14 +8453,14 @@ var9 (void)
 /*------------------------------------------------------------------------*/
 
 static int
-sort0 (void)
+heap0 (void)
 {
   int res, leaked;
   Limmat *limmat;
 
   limmat = new_Limmat (0);
   init_order (limmat);
-  res = is_sorted (limmat);
+  res = is_heap (limmat);
   leaked = internal_delete_Limmat (limmat);
   if (res)
     res = !leaked;
@@ -6665,10 +8470,10 @@ sort0 (void)
 
 /*------------------------------------------------------------------------*/
 
-#define N_SORT1 3
+#define N_HEAP1 3
 
 static int
-sort1 (void)
+heap1 (void)
 {
   int c[3][2][2], i[3][2], j, k, s, id, res, leaked;
   Limmat *limmat;
@@ -6682,12 +8487,12 @@ sort1 (void)
       }
 
   res = 1;
-  for (i[0][0] = 0; i[0][0] < N_SORT1; i[0][0]++)
-    for (i[0][1] = 0; i[0][1] < N_SORT1; i[0][1]++)
-      for (i[1][0] = 0; i[1][0] < N_SORT1; i[1][0]++)
-	for (i[1][1] = 0; i[1][1] < N_SORT1; i[1][1]++)
-	  for (i[2][0] = 0; i[2][0] < N_SORT1; i[2][0]++)
-	    for (i[2][1] = 0; i[2][1] < N_SORT1; i[2][1]++)
+  for (i[0][0] = 0; i[0][0] < N_HEAP1; i[0][0]++)
+    for (i[0][1] = 0; i[0][1] < N_HEAP1; i[0][1]++)
+      for (i[1][0] = 0; i[1][0] < N_HEAP1; i[1][0]++)
+	for (i[1][1] = 0; i[1][1] < N_HEAP1; i[1][1]++)
+	  for (i[2][0] = 0; i[2][0] < N_HEAP1; i[2][0]++)
+	    for (i[2][1] = 0; i[2][1] < N_HEAP1; i[2][1]++)
 	      {
 		limmat = new_Limmat (0);
 
@@ -6698,7 +8503,7 @@ sort1 (void)
 
 		init_order (limmat);
 		if (res)
-		  res = is_sorted (limmat);
+		  res = is_heap (limmat);
 		leaked = internal_delete_Limmat (limmat);
 		if (res)
 		  res = !leaked;
@@ -7470,6 +9275,426 @@ api4 (void)
 
 /*------------------------------------------------------------------------*/
 
+static int
+api5 (void)
+{
+  int res, leaked, clause[3];
+  const int *assignment;
+  Limmat *limmat;
+
+  limmat = new_Limmat (0);
+  clause[2] = 0;
+  clause[0] = 1;
+  clause[1] = 2;
+  add_Limmat (limmat, clause);
+  clause[0] = -1;
+  clause[1] = 3;
+  add_Limmat (limmat, clause);
+  clause[0] = -2;
+  clause[1] = 3;
+  add_Limmat (limmat, clause);
+
+  assume_Limmat (limmat, -3);
+  res = (sat_Limmat (limmat, -1) == 0);
+
+  if (res)
+    res = (sat_Limmat (limmat, -1) == 1);
+
+  if (res)
+    {
+      assume_Limmat (limmat, -1);
+      res = (sat_Limmat (limmat, -1) == 1);
+    }
+
+  if (res)
+    {
+      assignment = assignment_Limmat (limmat);
+      res = (assignment != 0);
+      if (res)
+	res = (assignment[0] == -1 && assignment[1] == 2 &&
+	       assignment[2] == 3 && !assignment[3]);
+    }
+
+  if (res)
+    {
+      clause[0] = -3;
+      clause[1] = 0;
+      add_Limmat (limmat, clause);
+      res = (sat_Limmat (limmat, -1) == 0);
+    }
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+api6 (void)
+{
+  int res, leaked, clause[3];
+  const int *assignment;
+  Limmat *limmat;
+
+  limmat = new_Limmat (0);
+  clause[0] = 1;
+  clause[1] = 2;
+  clause[2] = 0;
+  add_Limmat (limmat, clause);
+  clause[0] = -1;
+  clause[1] = 0;
+  add_Limmat (limmat, clause);
+  res = (sat_Limmat (limmat, -1) == 1);
+
+  if (res)
+    {
+      reset_Limmat (limmat);
+      res = (maxvar_Limmat (limmat) == 0 && clauses_Limmat (limmat) == 0);
+    }
+
+  if (res)
+    {
+      clause[0] = -2;
+      clause[1] = 0;
+      add_Limmat (limmat, clause);
+      res = (sat_Limmat (limmat, -1) == 1);
+    }
+
+  if (res)
+    {
+      assignment = assignment_Limmat (limmat);
+      res = (assignment && assignment[0] == -2 && !assignment[1]);
+    }
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Pigeon hole formula with 'holes + 1' pigeons and 'holes' holes.
+ */
+#define MAX_HOLES 8
+
+static void
+add_pigeon_hole (Limmat * limmat, int holes)
+{
+  int p, q, h, clause[MAX_HOLES + 1];
+
+  assert (holes <= MAX_HOLES);
+
+  for (p = 0; p <= holes; p++)
+    {
+      for (h = 0; h < holes; h++)
+	clause[h] = holes * p + h + 1;
+      clause[holes] = 0;
+      add_Limmat (limmat, clause);
+    }
+
+  clause[2] = 0;
+  for (h = 0; h < holes; h++)
+    for (p = 0; p <= holes; p++)
+      for (q = p + 1; q <= holes; q++)
+	{
+	  clause[0] = -(holes * p + h + 1);
+	  clause[1] = -(holes * q + h + 1);
+	  add_Limmat (limmat, clause);
+	}
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+api7 (void)
+{
+  Limmat *limmat;
+  int res, leaked;
+
+  limmat = new_Limmat (0);
+  add_pigeon_hole (limmat, 3);
+
+  set_conflict_limit_Limmat (limmat, 1);
+  res = (sat_Limmat (limmat, -1) < 0);
+
+  if (res)
+    {
+      set_conflict_limit_Limmat (limmat, -1);
+      set_memory_limit_Limmat (limmat, 1);
+      res = (sat_Limmat (limmat, -1) < 0);
+    }
+
+  if (res)
+    {
+      set_memory_limit_Limmat (limmat, 0);
+      res = (sat_Limmat (limmat, -1) == 0);
+    }
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+api8 (void)
+{
+  static const int untrusted[] = { 1, 2, 2, 0, -1, -1, 0, 3, -3, 0, 2, -4, 0 };
+  static const int trusted[] = { -2, 4, 0, -4, 0 };
+  static const int empty[] = { 1, 0, 0, 2, 0 };
+  Limmat *limmat;
+  int res, leaked;
+
+  limmat = new_Limmat (0);
+  add_clauses_Limmat (limmat, untrusted, 4, 0);
+  res = (clauses_Limmat (limmat) == 3 && maxvar_Limmat (limmat) == 4);
+  if (res)
+    res = (literals_Limmat (limmat) == 5);
+  if (res)
+    res = (sat_Limmat (limmat, -1) == 1);
+
+  if (res)
+    {
+      add_clauses_Limmat (limmat, trusted, 2, 1);
+      res = (clauses_Limmat (limmat) == 5);
+    }
+
+  if (res)
+    res = (sat_Limmat (limmat, -1) == 0);
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  if (res)
+    {
+      limmat = new_Limmat (0);
+      add_clauses_Limmat (limmat, empty, 3, 0);
+      res = (sat_Limmat (limmat, -1) == 0);
+      leaked = internal_delete_Limmat (limmat);
+      if (res)
+	res = !leaked;
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Reduce learned clauses after every few conflicts and check that the
+ * result is still correct and the clause data base is consistent.
+ */
+static int
+api9 (void)
+{
+  Limmat *limmat;
+  int res, leaked;
+
+  limmat = new_Limmat (0);
+  add_pigeon_hole (limmat, 6);
+
+  limmat->reduce_init = 10;
+  limmat->reduce_interval = 10;
+  limmat->next_reduce = 10;
+
+  res = (sat_Limmat (limmat, -1) == 0);
+
+  if (res && limmat->stats)
+    res = (limmat->stats->reductions > 0 &&
+	   limmat->stats->removed_clauses > 0);
+
+  if (res)
+    res = (count_Stack (&limmat->clauses) == limmat->num_clauses);
+
+  if (res)
+    res = ((char *) end_of_Arena (&limmat->clause_arena) -
+	   (char *) start_of_Arena (&limmat->clause_arena) ==
+	   limmat->num_clauses * bytes_Clause (0) +
+	   limmat->num_literals * sizeof (int));
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Units propagated through binary and ternary clauses only.
+ */
+static int
+api10 (void)
+{
+  static const int clauses[] = {
+    -1, 2, 0, -2, 3, 0, -3, -4, 5, 0, -5, -6, 7, 0,
+    1, 0, 6, 0, 4, 0
+  };
+  static const int conflict[] = { -7, -2, -4, 0 };
+  const int *assignment, *p;
+  Limmat *limmat;
+  int res, leaked;
+
+  limmat = new_Limmat (0);
+  add_clauses_Limmat (limmat, clauses, 7, 1);
+  res = (sat_Limmat (limmat, -1) == 1);
+
+  if (res)
+    res = (limmat->num_decisions == 0);
+
+  if (res)
+    {
+      assignment = assignment_Limmat (limmat);
+      for (p = assignment; res && *p; p++)
+	res = (*p > 0);
+    }
+
+  if (res)
+    {
+      add_clauses_Limmat (limmat, conflict, 1, 1);
+      res = (sat_Limmat (limmat, -1) == 0);
+    }
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Rephase after every few conflicts, such that all kinds of rephasing are
+ * used, and check that the result is still correct.
+ */
+static int
+api11 (void)
+{
+  Limmat *limmat;
+  int res, leaked;
+
+  limmat = new_Limmat (0);
+  add_pigeon_hole (limmat, 6);
+
+  limmat->rephase_init = 2;
+  limmat->next_rephase = 2;
+
+  res = (sat_Limmat (limmat, -1) == 0);
+
+  if (res)
+    res = (limmat->rephases >= 4);
+
+  if (res && limmat->stats)
+    res = (limmat->stats->rephased[ORIGINAL_PHASES] > 0 &&
+	   limmat->stats->rephased[INVERTED_PHASES] > 0 &&
+	   limmat->stats->rephased[BEST_PHASES] > 0);
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Restart after every few decisions, such that decision levels are reused,
+ * and check that the result is still correct.
+ */
+static int
+api12 (void)
+{
+  Limmat *limmat;
+  int res, leaked;
+
+  limmat = new_Limmat (0);
+  add_pigeon_hole (limmat, 6);
+
+  init_Counter (&limmat->restart, 5, 1, 1);
+
+  res = (sat_Limmat (limmat, -1) == 0);
+
+  if (res)
+    res = (limmat->restart.finished > 0);
+
+  if (res && limmat->stats)
+    res = (limmat->stats->reused > 0);
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Check the Luby sequence and the results with Luby and glucose restarts,
+ * which are forced to happen as often as possible.
+ */
+static int
+api13 (void)
+{
+  static const int sequence[] = { 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8 };
+  Limmat *limmat;
+  int res, leaked, i;
+
+  for (i = 0, res = 1; res && i < 15; i++)
+    res = (luby (i) == sequence[i]);
+
+  for (i = LIMMAT_LUBY_RESTARTS; res && i <= LIMMAT_GLUCOSE_RESTARTS; i++)
+    {
+      limmat = new_Limmat (0);
+      add_pigeon_hole (limmat, 6);
+
+      set_restart_policy_Limmat (limmat, i);
+      limmat->luby_unit = 1;
+      limmat->glucose_margin = 0;
+      schedule_restart (limmat);
+
+      res = (sat_Limmat (limmat, -1) == 0);
+
+      if (res)
+	res = (limmat->restart.finished > 0);
+
+      leaked = internal_delete_Limmat (limmat);
+      if (res)
+	res = !leaked;
+    }
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Minimize learned clauses and check that literals are actually removed
+ * and the result is still correct.
+ */
+static int
+api14 (void)
+{
+  Limmat *limmat;
+  int res, leaked;
+
+  limmat = new_Limmat (0);
+  add_pigeon_hole (limmat, 6);
+  limmat->minimize = 1;
+
+  res = (sat_Limmat (limmat, -1) == 0);
+
+  if (res && limmat->stats)
+    res = (limmat->stats->minimized_literals > 0);
+
+  leaked = internal_delete_Limmat (limmat);
+  if (res)
+    res = !leaked;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
 static void
 run (int (*tc) (void), Suite * suite, char *name, int n)
 {
@@ -7650,8 +9875,8 @@ main (int argc, char **argv)
   TF (var, 8);
   TF (var, 9);
 
-  TF (sort, 0);
-  TF (sort, 1);
+  TF (heap, 0);
+  TF (heap, 1);
 
   TF (parser, 0);
   TF (parser, 1);
@@ -7724,6 +9949,16 @@ main (int argc, char **argv)
   TF (api, 2);
   TF (api, 3);
   TF (api, 4);
+  TF (api, 5);
+  TF (api, 6);
+  TF (api, 7);
+  TF (api, 8);
+  TF (api, 9);
+  TF (api, 10);
+  TF (api, 11);
+  TF (api, 12);
+  TF (api, 13);
+  TF (api, 14);
 
   if ((!suite.backspaces && suite.ok) || suite.failed)
     line ();
@@ -28,6 +28,13 @@ Limmat *new_Limmat (FILE * log);
 void delete_Limmat (Limmat *);
 void set_log_Limmat (Limmat *, FILE * log);
 
+/*------------------------------------------------------------------------*/
+/* Remove all clauses and variables and reset counters and statistics, such
+ * that the solver can be used for a new problem.  In contrast to deleting
+ * the solver and creating a new one, allocated buffers are kept.
+ */
+void reset_Limmat (Limmat *);
+
 /*------------------------------------------------------------------------*/
 
 const char *id_Limmat (void);	/* RCS Id */
@@ -53,6 +60,16 @@ const char *error_Limmat (Limmat *);
  */
 void add_Limmat (Limmat *, const int *clause);
 
+/*------------------------------------------------------------------------*/
+/* Add 'num_clauses' zero terminated lists of literals, which are stored one
+ * after the other in 'clauses'.  Memory for all variables, clauses and
+ * literals is allocated at once.  If 'trusted' is non zero the caller
+ * guarantees that no clause contains a literal twice or a literal together
+ * with its negation and the check for these cases is skipped.
+ */
+void add_clauses_Limmat (Limmat *, const int *clauses, int num_clauses,
+			 int trusted);
+
 /*------------------------------------------------------------------------*/
 /* Print the current clause data base to the given file in DIMACS format.
  */
@@ -92,9 +109,47 @@ void adjust_timer_Limmat (Limmat *);
 double time_Limmat (Limmat *);
 
 /*------------------------------------------------------------------------*/
-/* Get number of currently allocated bytes in the library.
+/* Get number of currently allocated bytes in the library and the maximal
+ * number of bytes allocated so far.
  */
 size_t bytes_Limmat (Limmat *);
+size_t max_bytes_Limmat (Limmat *);
+
+/*------------------------------------------------------------------------*/
+/* Limit the time spent in one call to 'sat_Limmat' to the given number of
+ * seconds.  If the limit is exceeded 'sat_Limmat' returns a negative value.
+ * A negative limit, which is the default, disables the limit.  The limit is
+ * on wall clock time, measured from the start of 'sat_Limmat'.
+ */
+void set_time_limit_Limmat (Limmat *, double seconds);
+
+/*------------------------------------------------------------------------*/
+/* Limit the number of conflicts in one call to 'sat_Limmat'.  A negative
+ * limit, which is the default, disables the limit.
+ */
+void set_conflict_limit_Limmat (Limmat *, int conflicts);
+
+/*------------------------------------------------------------------------*/
+/* Limit the number of bytes allocated by the library.  If the limit is
+ * exceeded 'sat_Limmat' returns a negative value before the next decision.
+ * The solver can still be used, for instance to print statistics.  Zero,
+ * which is the default, disables the limit.
+ */
+void set_memory_limit_Limmat (Limmat *, size_t bytes);
+
+/*------------------------------------------------------------------------*/
+/* Select the restart policy.  Geometric restarts, the default, happen after
+ * a geometrically growing number of decisions.  Luby restarts follow the
+ * Luby sequence in units of conflicts.  Glucose restarts happen if recently
+ * learned clauses have a larger glue than on average, unless the trail is
+ * much larger than on average.  Other values are ignored.  The parameters
+ * of the policies are set by environment variables, see 'strategy_Limmat'.
+ */
+#define LIMMAT_GEOMETRIC_RESTARTS 0
+#define LIMMAT_LUBY_RESTARTS 1
+#define LIMMAT_GLUCOSE_RESTARTS 2
+
+void set_restart_policy_Limmat (Limmat *, int policy);
 
 /*------------------------------------------------------------------------*/
 /* Determine satisfiability:  'sat_Limmat' returns '0' if the stored clauses
@@ -111,6 +166,15 @@ size_t bytes_Limmat (Limmat *);
 int sat_Limmat (Limmat *, int max_decisions);
 const int *assignment_Limmat (Limmat *);
 
+/*------------------------------------------------------------------------*/
+/* Assume 'literal' to be true in the next call to 'sat_Limmat' only.  If
+ * the clauses together with the assumptions are unsatisfiable, then
+ * 'sat_Limmat' returns '0' without adding anything to the clauses, which
+ * can still be extended and solved again under different assumptions.
+ * Learned clauses are kept across calls.
+ */
+void assume_Limmat (Limmat *, int literal);
+
 /*------------------------------------------------------------------------*/
 /* Pretty print an assignment, a sequence of integers terminated by zero, by
  * wrapping numbers at a 80 column margin.
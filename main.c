@@ -1,4 +1,4 @@
-int limboole (int, char **);
+#include "limboole.h"
 
 int
 main (int argc, char **argv)
@@ -1,17 +1,35 @@
 #include <assert.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
 /*------------------------------------------------------------------------*/
 
-int limboole (int, char **);
+#include "limboole.h"
 
 /*------------------------------------------------------------------------*/
 
 typedef struct TestSuite TestSuite;
+typedef struct PerfEntry PerfEntry;
+
+/*------------------------------------------------------------------------*/
+/* In performance mode each case has an entry with the median time of the
+ * baseline and the tolerated slow down in percent.  Entries of cases not
+ * in the baseline have a negative 'baseline'.
+ */
+struct PerfEntry
+{
+  char *name;
+  double baseline;
+  double tolerance;
+  double median;		/* negative if not measured */
+};
 
 struct TestSuite
 {
@@ -20,6 +38,14 @@ struct TestSuite
   unsigned failed;
   unsigned ok;
   int keep;
+  int perf;
+  int runs;
+  int update;
+  const char *baseline;
+  unsigned slower;
+  PerfEntry *entries;
+  unsigned entries_count;
+  unsigned entries_size;
 };
 
 /*------------------------------------------------------------------------*/
@@ -59,6 +85,13 @@ cmp_files (const char *a, const char *b)
 
 /*------------------------------------------------------------------------*/
 
+#define PERF_RUNS 5		/* default number of timed runs */
+#define PERF_TOLERANCE 50	/* default tolerance in percent */
+#define PERF_MIN_DIFFERENCE 0.002	/* below timer and scheduler noise */
+#define PERF_MIN_BASELINE 0.01	/* faster cases are not kept in baseline */
+
+/*------------------------------------------------------------------------*/
+
 static int
 match (const char *str, const char *pattern)
 {
@@ -72,8 +105,105 @@ match (const char *str, const char *pattern)
 
 /*------------------------------------------------------------------------*/
 
+static PerfEntry *
+find_entry (TestSuite * ts, const char *name)
+{
+  PerfEntry *res;
+  unsigned i;
+
+  for (i = 0; i < ts->entries_count; i++)
+    if (!strcmp (ts->entries[i].name, name))
+      return ts->entries + i;
+
+  if (ts->entries_count == ts->entries_size)
+    {
+      ts->entries_size = ts->entries_size ? 2 * ts->entries_size : 64;
+      ts->entries = (PerfEntry *)
+	realloc (ts->entries, ts->entries_size * sizeof (PerfEntry));
+    }
+
+  res = ts->entries + ts->entries_count++;
+  res->name = strdup (name);
+  res->baseline = -1;
+  res->tolerance = PERF_TOLERANCE;
+  res->median = -1;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* The baseline file has one line '<name> <median> <tolerance>' per case.
+ * Lines starting with '#' are comments.
+ */
+static int
+read_baseline (TestSuite * ts)
+{
+  double median, tolerance;
+  char line[200], name[100];
+  PerfEntry *entry;
+  FILE *file;
+
+  if (!(file = fopen (ts->baseline, "r")))
+    return 0;
+
+  while (fgets (line, sizeof (line), file))
+    {
+      if (line[0] == '#')
+	continue;
+
+      if (sscanf (line, "%99s %lf %lf", name, &median, &tolerance) != 3)
+	continue;
+
+      entry = find_entry (ts, name);
+      entry->baseline = median;
+      entry->tolerance = tolerance;
+    }
+
+  fclose (file);
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+/* Cases faster than 'PERF_MIN_BASELINE' are dominated by noise and are not
+ * written to the baseline.
+ */
+static int
+write_baseline (TestSuite * ts)
+{
+  PerfEntry *entry;
+  double median;
+  FILE *file;
+  unsigned i;
+
+  if (!(file = fopen (ts->baseline, "w")))
+    return 0;
+
+  fprintf (file, "# name median-seconds tolerance-percent\n");
+
+  for (i = 0; i < ts->entries_count; i++)
+    {
+      entry = ts->entries + i;
+      median = entry->median >= 0 ? entry->median : entry->baseline;
+      if (median >= PERF_MIN_BASELINE)
+	fprintf (file, "%s %.6f %.0f\n",
+		 entry->name, median, entry->tolerance);
+    }
+
+  fclose (file);
+
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
 #define USAGE \
-"usage: testlimboole [-h|-k|--version] [ <pattern> ]\n"
+"usage: testlimboole [-h|-k|--version] [ <perf-option> ... ] [ <pattern> ]\n" \
+"\n" \
+"  --perf             time the cases and compare to the baseline\n" \
+"  --runs <n>         number of timed runs per case (default 5)\n" \
+"  --baseline <file>  baseline file (default 'log/perf.baseline')\n" \
+"  --update           write the measured times to the baseline file\n"
 
 #define ID \
 "$Id: test.c,v 1.9 2002/11/07 07:12:07 biere Exp $\n"
@@ -93,6 +223,8 @@ main (int argc, char **argv)
   int i;
 
   memset (&ts, 0, sizeof (ts));
+  ts.runs = PERF_RUNS;
+  ts.baseline = "log/perf.baseline";
   error = 0;
   done = 0;
 
@@ -112,6 +244,33 @@ main (int argc, char **argv)
 	  printf (ID);
 	  done = 1;
 	}
+      else if (!strcmp (argv[i], "--perf"))
+	{
+	  ts.perf = 1;
+	}
+      else if (!strcmp (argv[i], "--update"))
+	{
+	  ts.perf = 1;
+	  ts.update = 1;
+	}
+      else if (!strcmp (argv[i], "--runs"))
+	{
+	  if (i + 1 == argc || (ts.runs = atoi (argv[++i])) <= 0)
+	    {
+	      fprintf (stderr, "*** invalid or missing number of runs\n");
+	      error = 1;
+	    }
+	}
+      else if (!strcmp (argv[i], "--baseline"))
+	{
+	  if (i + 1 == argc)
+	    {
+	      fprintf (stderr, "*** missing baseline file\n");
+	      error = 1;
+	    }
+	  else
+	    ts.baseline = argv[++i];
+	}
       else if (ts.pattern)
 	{
 	  fprintf (stderr, "*** multiple patterns specified (try '-h')\n");
@@ -127,10 +286,31 @@ main (int argc, char **argv)
   if (done)
     return 0;
 
+  if (ts.perf && !read_baseline (&ts) && !ts.update)
+    {
+      fprintf (stderr, "*** can not read baseline '%s'\n", ts.baseline);
+      return 1;
+    }
+
   run_all (&ts);
   printf ("%u ok, %u failed (out of %u)\n", ts.ok, ts.failed, ts.count);
 
-  return 0;
+  if (!ts.perf)
+    return 0;
+
+  printf ("%u slower than baseline\n", ts.slower);
+
+  if (ts.update && !write_baseline (&ts))
+    {
+      fprintf (stderr, "*** can not write baseline '%s'\n", ts.baseline);
+      return 1;
+    }
+
+  for (i = 0; i < (int) ts.entries_count; i++)
+    free (ts.entries[i].name);
+  free (ts.entries);
+
+  return ts.failed || (ts.slower && !ts.update);
 }
 
 /*------------------------------------------------------------------------*/
@@ -178,23 +358,263 @@ erase (TestSuite * ts)
 /*------------------------------------------------------------------------*/
 
 static void
-run (TestSuite * ts, int expected_res, int argc, ...)
+report (TestSuite * ts, int res)
+{
+  ts->count++;
+  if (res)
+    {
+      printf (" ok    ");
+      if (!erase (ts))
+	fputc ('\n', stdout);
+      ts->ok++;
+    }
+  else
+    {
+      printf (" failed\n");
+      ts->failed++;
+    }
+}
+
+/*------------------------------------------------------------------------*/
+
+static double
+wall_clock (void)
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, 0);
+
+  return tv.tv_sec + 1e-6 * tv.tv_usec;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+cmp_double (const void *p, const void *q)
+{
+  double a, b;
+
+  a = *(const double *) p;
+  b = *(const double *) q;
+
+  return (a < b) ? -1 : (a > b);
+}
+
+/*------------------------------------------------------------------------*/
+
+static double
+median (double *a, int n)
+{
+  qsort (a, n, sizeof (double), cmp_double);
+
+  return (n & 1) ? a[n / 2] : (a[n / 2 - 1] + a[n / 2]) / 2;
+}
+
+/*------------------------------------------------------------------------*/
+/* Report median and median absolute deviation of the times of one case and
+ * compare the median to the baseline.  A case is slower if the median
+ * exceeds the baseline by more than its tolerance and also by more than
+ * three deviations and the timer noise.  The array 'times' is clobbered.
+ */
+static void
+report_perf (TestSuite * ts, const char *name, double *times)
+{
+  double med, mad, change, limit;
+  const char *verdict;
+  PerfEntry *entry;
+  int i;
+
+  med = median (times, ts->runs);
+  for (i = 0; i < ts->runs; i++)
+    times[i] = (times[i] > med) ? times[i] - med : med - times[i];
+  mad = median (times, ts->runs);
+
+  entry = find_entry (ts, name);
+  entry->median = med;
+
+  ts->count++;
+  ts->ok++;
+
+  printf (" %9.6f +- %9.6f", med, mad);
+
+  if (entry->baseline < 0)
+    {
+      printf ("                      %s\n",
+	      med < PERF_MIN_BASELINE ? "noise" : "new");
+      return;
+    }
+
+  change = entry->baseline > 0 ?
+    100 * (med - entry->baseline) / entry->baseline : 0;
+
+  limit = 3 * mad;
+  if (limit < PERF_MIN_DIFFERENCE)
+    limit = PERF_MIN_DIFFERENCE;
+
+  if (change > entry->tolerance && med - entry->baseline > limit)
+    {
+      verdict = "SLOWER";
+      ts->slower++;
+    }
+  else
+    verdict = "ok";
+
+  printf (" %9.6f %+7.1f%%  %s\n", entry->baseline, change, verdict);
+}
+
+/*------------------------------------------------------------------------*/
+/* Find the end of the token starting at 'p' and check whether it only
+ * consists of digits and decimal points.
+ */
+static int
+number_token (const char *p, const char **end_ptr, int *point_ptr)
+{
+  int res;
+
+  res = 1;
+  *point_ptr = 0;
+
+  for (; *p && !isspace ((int) *p); p++)
+    if (*p == '.')
+      *point_ptr = 1;
+    else if (!isdigit ((int) *p))
+      res = 0;
+
+  *end_ptr = p;
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Replace every number in a line, which contains a number with a decimal
+ * point, by '#'.  These are the status lines of batch and server mode with
+ * wall clock times and byte counts, which differ from machine to machine.
+ */
+static void
+mask_line (const char *line, char *res)
+{
+  int has_point, point;
+  const char *p, *q;
+
+  has_point = 0;
+  for (p = line; *p; p = q)
+    if (isspace ((int) *p))
+      q = p + 1;
+    else if (number_token (p, &q, &point) && point)
+      has_point = 1;
+
+  for (p = line; *p; p = q)
+    if (isspace ((int) *p))
+      {
+	*res++ = *p;
+	q = p + 1;
+      }
+    else if (number_token (p, &q, &point) && has_point)
+      *res++ = '#';
+    else
+      {
+	memcpy (res, p, q - p);
+	res += q - p;
+      }
+
+  *res = 0;
+}
+
+/*------------------------------------------------------------------------*/
+/* Same as 'cmp_files' but with the numbers of status lines masked.
+ */
+static int
+cmp_masked (const char *a, const char *b)
+{
+  char f_line[400], g_line[400];
+  char f_mask[400], g_mask[400];
+  int f_read, g_read;
+  FILE *f;
+  FILE *g;
+  int res;
+
+  res = 1;
+
+  if (!(f = fopen (a, "r")))
+    res = 0;
+  if (!(g = fopen (b, "r")))
+    res = 0;
+
+  while (res)
+    {
+      f_read = (fgets (f_line, sizeof f_line, f) != 0);
+      g_read = (fgets (g_line, sizeof g_line, g) != 0);
+      if (!f_read || !g_read)
+	{
+	  res = (f_read == g_read);
+	  break;
+	}
+
+      mask_line (f_line, f_mask);
+      mask_line (g_line, g_mask);
+      res = !strcmp (f_mask, g_mask);
+    }
+
+  if (f)
+    fclose (f);
+  if (g)
+    fclose (g);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Run one case and check its exit code and, if 'out_name' is non zero, its
+ * output.  In performance mode this first run is a warm-up and the case is
+ * run again 'runs' times to measure it.
+ */
+static void
+execute (TestSuite * ts, int expected_res, int masked, const char *name,
+	 const char *out_name, const char *log_name, int argc, char **argv)
+{
+  double *times, start;
+  int res, i;
+
+  res = (limboole (argc, argv) == expected_res);
+  if (res && out_name)
+    res = masked ?
+      cmp_masked (out_name, log_name) : cmp_files (out_name, log_name);
+
+  if (!ts->perf || !res)
+    {
+      report (ts, res);
+      return;
+    }
+
+  times = (double *) malloc (ts->runs * sizeof (double));
+
+  for (i = 0; i < ts->runs; i++)
+    {
+      start = wall_clock ();
+      limboole (argc, argv);
+      times[i] = wall_clock () - start;
+    }
+
+  report_perf (ts, name, times);
+  free (times);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+run_va (TestSuite * ts, int expected_res, int masked, int argc, va_list ap)
 {
   char *out_name;
   char *log_name;
   char **my_argv;
-  int real_res;
   char *name;
   int my_argc;
-  va_list ap;
   int matched;
-  int res;
   int len;
   int i;
 
   assert (argc > 0);
 
-  va_start (ap, argc);
   name = va_arg (ap, char *);
 
   matched = (!ts->pattern || match (name, ts->pattern));
@@ -222,32 +642,518 @@ run (TestSuite * ts, int expected_res, int argc, ...)
       for (i = 1; i < argc; i++)
 	my_argv[i + 4] = va_arg (ap, char *);
 
-      real_res = limboole (my_argc, my_argv);
-      res = (real_res == expected_res);
-      if (res)
-	res = cmp_files (out_name, log_name);
-
+      execute (ts, expected_res, masked, name, out_name, log_name,
+	       my_argc, my_argv);
       free (my_argv);
 
-      ts->count++;
-      if (res)
+      free (out_name);
+      free (log_name);
+    }
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+run (TestSuite * ts, int expected_res, int argc, ...)
+{
+  va_list ap;
+
+  va_start (ap, argc);
+  run_va (ts, expected_res, 0, argc, ap);
+  va_end (ap);
+}
+
+/*------------------------------------------------------------------------*/
+/* Compare the output with the times and bytes of status lines masked.
+ */
+static void
+run_masked (TestSuite * ts, int expected_res, int argc, ...)
+{
+  va_list ap;
+
+  va_start (ap, argc);
+  run_va (ts, expected_res, 1, argc, ap);
+  va_end (ap);
+}
+
+/*------------------------------------------------------------------------*/
+/* Test cases for the library interface.
+ */
+static void
+api (TestSuite * ts, const char *name, int (*test) (void))
+{
+  if (ts->pattern && !match (name, ts->pattern))
+    return;
+
+  printf ("%-20s ...", name);
+  fflush (stdout);
+  report (ts, test ());
+}
+
+/*------------------------------------------------------------------------*/
+/* Compare only the first word of each line, e.g. the keys of statistics,
+ * whose values differ from run to run.
+ */
+static int
+cmp_keys (const char *a, const char *b)
+{
+  char f_key[80], g_key[80];
+  char line[200];
+  FILE *f;
+  FILE *g;
+  int res;
+
+  res = 1;
+
+  if (!(f = fopen (a, "r")))
+    res = 0;
+  if (!(g = fopen (b, "r")))
+    res = 0;
+
+  while (res)
+    {
+      f_key[0] = g_key[0] = 0;
+      if (fgets (line, sizeof line, f))
+	sscanf (line, "%79s", f_key);
+      if (fgets (line, sizeof line, g))
+	sscanf (line, "%79s", g_key);
+      res = !strcmp (f_key, g_key);
+      if (!f_key[0])
+	break;
+    }
+
+  if (f)
+    fclose (f);
+  if (g)
+    fclose (g);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* The statistics of '--stats' are printed after the result.
+ */
+static int
+stats0 (void)
+{
+  char *argv[] = {
+    "stats0", "-o", "log/stats0.log", "-l", "log/stats0.log",
+    "--stats", "log/valid1.in"
+  };
+
+  if (limboole (7, argv))
+    return 0;
+
+  return cmp_keys ("log/stats0.out", "log/stats0.log");
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+api0 (void)
+{
+  LimbooleNode *root;
+  Limboole *lb;
+  int res;
+
+  lb = new_Limboole ();
+  root = parse_Limboole (lb, "a & !a");
+  res = (root != 0);
+  if (res)
+    res = (sat_Limboole (lb, root) == 0);
+  if (res)
+    res = (valid_Limboole (lb, not_Limboole (lb, root)) == 1);
+  if (res)
+    res = (model_size_Limboole (lb) == 0);
+  delete_Limboole (lb);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+api1 (void)
+{
+  LimbooleNode *a, *b, *root;
+  Limboole *lb;
+  int res;
+
+  lb = new_Limboole ();
+  a = var_Limboole (lb, "a");
+  b = var_Limboole (lb, "b");
+  root = and_Limboole (lb, implies_Limboole (lb, a, b), a);
+  res = (root == parse_Limboole (lb, "(a -> b) & a"));
+  if (res)
+    res = (sat_Limboole (lb, root) == 1);
+  if (res)
+    res = (model_size_Limboole (lb) == 2);
+  if (res)
+    res = !strcmp (model_name_Limboole (lb, 0), "a");
+  if (res)
+    res = !strcmp (model_name_Limboole (lb, 1), "b");
+  if (res)
+    res = (model_value_Limboole (lb, 0) == 1);
+  if (res)
+    res = (model_value_Limboole (lb, 1) == 1);
+  if (res)
+    res = (value_Limboole (lb, root) == 1);
+  delete_Limboole (lb);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+api2 (void)
+{
+  const char *error;
+  Limboole *lb;
+  int res;
+
+  lb = new_Limboole ();
+  res = !parse_Limboole (lb, "a &\n");
+  if (res)
+    {
+      error = error_Limboole (lb);
+      res = (error && !strcmp (error, "<string>:2:1: parse error at 'EOF' "
+			       "expected variable or '('"));
+    }
+  if (res)
+    res = !parse_Limboole (lb, "q : a;");
+  if (res)
+    res = (parse_Limboole (lb, "a") != 0);
+  if (res)
+    res = !error_Limboole (lb);
+  delete_Limboole (lb);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+api3 (void)
+{
+  LimbooleNode *x, *y;
+  Limboole *lb;
+  int res;
+
+  lb = new_Limboole ();
+  x = parse_Limboole (lb, "x := a & b; x");
+  res = (x != 0);
+  if (res)
+    res = (sat_Limboole (lb, x) == 1);
+  if (res)
+    res = (model_size_Limboole (lb) == 2);
+  if (res)
+    {
+      y = parse_Limboole (lb, "x -> c");
+      res = (y != 0);
+    }
+  if (res)
+    res = (valid_Limboole (lb, y) == 0);
+  if (res)
+    res = (model_size_Limboole (lb) == 3);
+  if (res)
+    res = (value_Limboole (lb, x) == 1);
+  if (res)
+    res = (model_value_Limboole (lb, 2) == 0);
+  if (res)
+    res = (valid_Limboole (lb, parse_Limboole (lb, "x -> a")) == 1);
+  if (res)
+    res = (sat_Limboole (lb, parse_Limboole (lb, "x & !b")) == 0);
+  delete_Limboole (lb);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Each thread checks the pigeon hole formula with 'n + 1' pigeons and 'n'
+ * holes on its own handle.
+ */
+static void *
+pigeon_hole (void *arg)
+{
+  LimbooleNode *root, *clause;
+  char name[32];
+  Limboole *lb;
+  int i, j, k;
+  long n;
+
+  n = (long) arg;
+  lb = new_Limboole ();
+  root = 0;
+
+  for (i = 0; i <= n; i++)
+    {
+      clause = 0;
+      for (j = 0; j < n; j++)
 	{
-	  printf (" ok    ");
-	  if (!erase (ts))
-	    fputc ('\n', stdout);
-	  ts->ok++;
+	  snprintf (name, sizeof name, "p%d_%d", i, j);
+	  clause = clause ?
+	    or_Limboole (lb, clause, var_Limboole (lb, name)) :
+	    var_Limboole (lb, name);
 	}
-      else
+      root = root ? and_Limboole (lb, root, clause) : clause;
+    }
+
+  for (j = 0; j < n; j++)
+    for (i = 0; i <= n; i++)
+      for (k = i + 1; k <= n; k++)
 	{
-	  printf (" failed\n");
-	  ts->failed++;
+	  snprintf (name, sizeof name, "p%d_%d", i, j);
+	  clause = not_Limboole (lb, var_Limboole (lb, name));
+	  snprintf (name, sizeof name, "p%d_%d", k, j);
+	  clause = or_Limboole (lb, clause,
+				not_Limboole (lb, var_Limboole (lb, name)));
+	  root = and_Limboole (lb, root, clause);
 	}
 
-      free (out_name);
-      free (log_name);
+  n = sat_Limboole (lb, root);
+  delete_Limboole (lb);
+
+  return (void *) n;
+}
+
+/*------------------------------------------------------------------------*/
+
+#define API4_THREADS 4
+
+static int
+api4 (void)
+{
+  pthread_t threads[API4_THREADS];
+  void *sat;
+  int i, res;
+
+  for (i = 0; i < API4_THREADS; i++)
+    pthread_create (threads + i, 0, pigeon_hole, (void *) (long) (i + 3));
+
+  res = 1;
+  for (i = 0; i < API4_THREADS; i++)
+    {
+      pthread_join (threads[i], &sat);
+      if (sat)
+	res = 0;
     }
 
-  va_end (ap);
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+write_file (const char *path, const char *text)
+{
+  FILE *file;
+
+  if (!(file = fopen (path, "w")))
+    return 0;
+
+  fputs (text, file);
+
+  return !fclose (file);
+}
+
+/*------------------------------------------------------------------------*/
+/* Wait at most five seconds until the output of the watch has more than
+ * 'size' bytes.
+ */
+static int
+wait_for_watch (long size)
+{
+  struct stat buf;
+  int i;
+
+  for (i = 0; i < 100; i++)
+    {
+      if (!stat ("log/watch0.log", &buf) && buf.st_size > size)
+	return 1;
+
+      usleep (50000);
+    }
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void *
+watch_thread (void *arg)
+{
+  static char *argv[] = {
+    "watch0", "-o", "log/watch0.log", "-l", "log/watch0.log",
+    "-w", "log/watch0.in"
+  };
+
+  (void) arg;
+
+  return (void *) (long) limboole (7, argv);
+}
+
+/*------------------------------------------------------------------------*/
+/* The watched file is rewritten once after the first result and removed
+ * after the second result, which ends the watch.
+ */
+static int
+watch0 (void)
+{
+  struct stat buf;
+  pthread_t thread;
+  void *exit_code;
+  int res;
+
+  unlink ("log/watch0.log");
+  if (!write_file ("log/watch0.in", "a | !a\n"))
+    return 0;
+
+  pthread_create (&thread, 0, watch_thread, 0);
+
+  res = wait_for_watch (0);
+  if (res)
+    res = !stat ("log/watch0.log", &buf);
+  if (res)
+    res = write_file ("log/watch0.in", "a & b\n");
+  if (res)
+    res = wait_for_watch ((long) buf.st_size);
+
+  unlink ("log/watch0.in");
+  pthread_join (thread, &exit_code);
+
+  if (res)
+    res = !exit_code;
+  if (res)
+    res = cmp_files ("log/watch0.out", "log/watch0.log");
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Larger generated cases, which are only run in performance mode.  The
+ * pigeon hole formula with 'n + 1' pigeons and 'n' holes is unsatisfiable.
+ */
+static void
+gen_pigeon_hole (FILE * file, int n)
+{
+  int i, j, k;
+
+  for (i = 0; i <= n; i++)
+    {
+      fprintf (file, "%s(", i ? " &\n" : "");
+      for (j = 0; j < n; j++)
+	fprintf (file, "%sp%d_%d", j ? " | " : "", i, j);
+      fputc (')', file);
+    }
+
+  for (j = 0; j < n; j++)
+    for (i = 0; i <= n; i++)
+      for (k = i + 1; k <= n; k++)
+	fprintf (file, " &\n(!p%d_%d | !p%d_%d)", i, j, k, j);
+
+  fputc ('\n', file);
+}
+
+/*------------------------------------------------------------------------*/
+/* A long chain of implications, which is valid.
+ */
+static void
+gen_chain (FILE * file, int n)
+{
+  int i;
+
+  fprintf (file, "x0");
+  for (i = 0; i < n; i++)
+    fprintf (file, " &\n(x%d -> x%d)", i, i + 1);
+  fprintf (file, "\n-> x%d\n", n);
+}
+
+/*------------------------------------------------------------------------*/
+/* The parity of 'n' variables associated to the left respectively to the
+ * right is equivalent, which is hard for the solver.
+ */
+static void
+gen_parity (FILE * file, int n)
+{
+  int i;
+
+  for (i = 1; i < n; i++)
+    fputc ('(', file);
+  fprintf (file, "x0");
+  for (i = 1; i < n; i++)
+    fprintf (file, " <-> x%d)", i);
+
+  fprintf (file, "\n<->\n");
+
+  for (i = 0; i < n - 1; i++)
+    fprintf (file, "(x%d <-> ", i);
+  fprintf (file, "x%d", n - 1);
+  for (i = 0; i < n - 1; i++)
+    fputc (')', file);
+  fputc ('\n', file);
+}
+
+/*------------------------------------------------------------------------*/
+/* Each definition uses the previous one twice.
+ */
+static void
+gen_defs (FILE * file, int n)
+{
+  int i;
+
+  fprintf (file, "d0 := x0;\n");
+  for (i = 1; i < n; i++)
+    fprintf (file, "d%d := (d%d & x%d) | (!d%d & !x%d);\n",
+	     i, i - 1, i, i - 1, i);
+  fprintf (file, "d%d\n", n - 1);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+generated (TestSuite * ts, const char *name, const char *option,
+	   void (*gen) (FILE *, int), int size)
+{
+  char *in_name, *log_name, *my_argv[7];
+  FILE *file;
+  int my_argc;
+  int len;
+
+  if (ts->pattern && !match (name, ts->pattern))
+    return;
+
+  printf ("%-20s ...", name);
+  fflush (stdout);
+
+  len = strlen (name);
+  in_name = (char *) malloc (len + 8);
+  sprintf (in_name, "log/%s.in", name);
+  log_name = (char *) malloc (len + 9);
+  sprintf (log_name, "log/%s.log", name);
+
+  if ((file = fopen (in_name, "w")))
+    {
+      gen (file, size);
+      fclose (file);
+
+      my_argc = 0;
+      my_argv[my_argc++] = (char *) name;
+      my_argv[my_argc++] = "-o";
+      my_argv[my_argc++] = log_name;
+      my_argv[my_argc++] = "-l";
+      my_argv[my_argc++] = log_name;
+      if (option)
+	my_argv[my_argc++] = (char *) option;
+      my_argv[my_argc++] = in_name;
+
+      execute (ts, 0, 0, name, 0, log_name, my_argc, my_argv);
+    }
+  else
+    report (ts, 0);
+
+  free (in_name);
+  free (log_name);
 }
 
 /*------------------------------------------------------------------------*/
@@ -288,6 +1194,63 @@ run_all (TestSuite * ts)
   run (ts, 0, 3, "ppandor", "-p", "log/ppandor.in");
   run (ts, 0, 3, "pp0", "-p", "log/pp0.in");
   run (ts, 0, 3, "pp1", "-p", "log/pp1.in");
+  run (ts, 0, 3, "def0", "-p", "log/def0.in");
+  run (ts, 0, 3, "def1", "-p", "log/def1.in");
+  run (ts, 0, 3, "def0sat", "-s", "log/def0.in");
+  run (ts, 0, 2, "def1valid", "log/def1.in");
+  run (ts, 1, 2, "defredefined", "log/defredefined.in");
+  run (ts, 1, 2, "defusedvar", "log/defusedvar.in");
+  run (ts, 1, 2, "defrecursive", "log/defrecursive.in");
+  run (ts, 1, 2, "defnosemi", "log/defnosemi.in");
+  run (ts, 1, 2, "defcolon", "log/defcolon.in");
+  run (ts, 0, 3, "query0", "-p", "log/query0.in");
+  run (ts, 0, 2, "query0valid", "log/query0.in");
+  run (ts, 0, 3, "query1sat", "-s", "log/query1.in");
+  run (ts, 0, 2, "query1valid", "log/query1.in");
+  run (ts, 1, 2, "querymain", "log/querymain.in");
+  run (ts, 1, 2, "querynosemi", "log/querynosemi.in");
+  run (ts, 1, 3, "querydump", "-d", "log/query1.in");
+  run_masked (ts, 1, 4, "batch0", "-b", "log/batch0.in", "-s");
+  run_masked (ts, 1, 8, "batchtime", "-s", "-j", "4", "-t", "1", "-b",
+	      "log/batchtime.in");
+  run (ts, 1, 2, "batchmissingpara", "-b");
+  run (ts, 1, 3, "batchnotreadable", "-b", "/a-non-existing-file");
+  run (ts, 1, 4, "batchpp", "-p", "-b", "log/batch0.in");
+  run_masked (ts, 0, 3, "serve0", "--serve", "log/serve0.in");
+  run_masked (ts, 0, 3, "servelarge", "--serve", "log/servelarge.in");
+  run (ts, 1, 4, "servepp", "--serve", "-p", "log/serve0.in");
+  run (ts, 1, 2, "socketmissingpara", "--socket");
+  run (ts, 0, 5, "cache0", "-s", "-c", "log/cache.cache", "log/cache0.in");
+  run (ts, 0, 5, "cache1", "-s", "-c", "log/cache.cache", "log/cache1.in");
+  run (ts, 0, 5, "cachebad", "-s", "-c", "log/cachebad.cache",
+       "log/cache0.in");
+  run (ts, 0, 5, "cachefull", "-s", "-c", "log/cachefull.cache",
+       "log/cache0.in");
+  run (ts, 1, 2, "cachemissingpara", "-c");
+  run (ts, 1, 2, "watchnofile", "-w");
+  run (ts, 1, 4, "watchpp", "-w", "-p", "log/and0.in");
+  run (ts, 0, 5, "scenario0", "-s", "-a", "log/scenario0.sce",
+       "log/scenario0.in");
+  run (ts, 0, 4, "scenario1", "-a", "log/scenario1.sce", "log/scenario1.in");
+  run (ts, 1, 5, "scenariobad", "-s", "-a", "log/scenariobad.sce",
+       "log/scenario0.in");
+  run (ts, 1, 2, "scenariomissingpara", "-a");
+  run (ts, 1, 5, "conflicts0", "-s", "--conflicts", "1",
+       "log/conflicts0.in");
+  run (ts, 1, 4, "invalidconflicts", "--conflicts", "0", "log/query1.in");
+  run (ts, 1, 4, "memory0", "--memory", "0.000001", "log/query1.in");
+  run (ts, 1, 4, "invalidmemory", "--memory", "x", "log/query1.in");
+  run (ts, 1, 2, "conflictsmissingpara", "--conflicts");
+  run (ts, 1, 2, "memorymissingpara", "--memory");
+  run (ts, 1, 2, "timemissingpara", "--time");
+  run (ts, 1, 4, "scenarionotreadable", "-a", "/a-non-existing-file",
+       "log/scenario0.in");
+  run (ts, 1, 6, "scenariocache", "-a", "log/scenario0.sce", "-c",
+       "log/cache.cache", "log/scenario0.in");
+  run (ts, 1, 5, "batchcache", "-c", "log/cache.cache", "-b",
+       "log/batch0.in");
+  run (ts, 1, 3, "invalidworkers", "-j", "0");
+  run (ts, 1, 2, "missingtpara", "-t");
   run (ts, 1, 2, "twovar", "log/twovar.in");
   run (ts, 1, 2, "iff2", "log/iff2.in");
   run (ts, 1, 2, "implies2", "log/implies2.in");
@@ -327,4 +1290,19 @@ run_all (TestSuite * ts)
   run (ts, 0, 2, "prime9", "log/prime9.in");
   run (ts, 0, 2, "count2live", "log/count2live.in");
   run (ts, 0, 2, "count2stall", "log/count2stall.in");
+  api (ts, "stats0", stats0);
+  api (ts, "watch0", watch0);
+  api (ts, "api0", api0);
+  api (ts, "api1", api1);
+  api (ts, "api2", api2);
+  api (ts, "api3", api3);
+  api (ts, "api4", api4);
+
+  if (!ts->perf)
+    return;
+
+  generated (ts, "genpigeonhole8", "-s", gen_pigeon_hole, 8);
+  generated (ts, "genchain", 0, gen_chain, 50000);
+  generated (ts, "genparity14", 0, gen_parity, 14);
+  generated (ts, "gendefs", "-s", gen_defs, 10000);
 }